@@ -11,26 +11,49 @@
 #include "defines.h"
 
 
+//Dirty-Maske je BMS (dataDirty_s.u8_bms[])
+#define DIRTY_BMS_CELLS     0x01  //Zellspannungen
+#define DIRTY_BMS_TOTALS    0x02  //Spannung, Strom, SoC, Min/Max/Diff/Avg
+#define DIRTY_BMS_TEMPS     0x04  //Temperaturen
+#define DIRTY_BMS_STATUS    0x08  //Fehler, Balancing
+
+//Dirty-Maske global (dataDirty_s.u8_global)
+#define DIRTY_INVERTER      0x01
+#define DIRTY_BSC_ALARMS    0x02
+#define DIRTY_BSC_RELAIS    0x04
+#define DIRTY_BSC_SETTINGS  0x08
+
+
+//Welche Feldgruppen sich seit dem vorherigen Zyklus geändert haben
+struct dataDirty_s
+{
+  uint8_t    u8_bms[BMS_DEVICES_COUNT];
+  uint8_t    u8_global;
+  uint32_t   u32_cells[BMS_DEVICES_COUNT];    //Geänderte Zellen (Bit n = Zelle n)
+  bool       bo_suspect;                      //Zyklus mit CRC-Fehlern oder Lücken in der Nummerierung
+};
+
+
 struct data_s
 {
-  //                                                                                 // NEEY 4A | JbdBms | JK-BMS | 
-  uint16_t   bmsCellVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT][24];          //    x    |   x    |   x    |
-  //float    bmsCellResistance[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT][24];       //    x    |        |        |
-  int16_t    bmsTotalVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];             //    x    |   x    |   x    |
-  uint16_t   bmsMaxCellDifferenceVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT]; //    x    |   x    |   x    |
-  uint16_t   bmsAvgVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];               //    x    |   x    |   x    |
-  int16_t    bmsTotalCurrent[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];             //         |   x    |   x    |
-  uint16_t   bmsMaxCellVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];           //    x    |   x    |   x    |
-  uint16_t   bmsMinCellVoltage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];           //    x    |   x    |   x    |
-  uint8_t    bmsMaxVoltageCellNumber[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];     //    x    |        |        |
-  uint8_t    bmsMinVoltageCellNumber[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];     //    x    |        |        |
-  uint8_t    bmsIsBalancingActive[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];        //    x    |        |        |
-  int16_t    bmsBalancingCurrent[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];         //    x    |        |        |
-  int16_t    bmsTemperature[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT][3];             //    2    |   3    |   3    |
-  uint8_t    bmsChargePercentage[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];         //         |   x    |   x    |
-  uint32_t   bmsErrors[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];                   //    *    |   x    |   x    |
-  unsigned long bmsLastDataMillis[BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT];        //    x    |   x    |   x    |
-  //                                                                                 // *=Teilweise
+  //                                                                // NEEY 4A | JbdBms | JK-BMS |
+  uint16_t   bmsCellVoltage[BMS_DEVICES_COUNT][BMS_CELLS_MAX];      //    x    |   x    |   x    |
+  //float    bmsCellResistance[BMS_DEVICES_COUNT][BMS_CELLS_MAX];   //    x    |        |        |
+  int16_t    bmsTotalVoltage[BMS_DEVICES_COUNT];                    //    x    |   x    |   x    |
+  uint16_t   bmsMaxCellDifferenceVoltage[BMS_DEVICES_COUNT];        //    x    |   x    |   x    |
+  uint16_t   bmsAvgVoltage[BMS_DEVICES_COUNT];                      //    x    |   x    |   x    |
+  int16_t    bmsTotalCurrent[BMS_DEVICES_COUNT];                    //         |   x    |   x    |
+  uint16_t   bmsMaxCellVoltage[BMS_DEVICES_COUNT];                  //    x    |   x    |   x    |
+  uint16_t   bmsMinCellVoltage[BMS_DEVICES_COUNT];                  //    x    |   x    |   x    |
+  uint8_t    bmsMaxVoltageCellNumber[BMS_DEVICES_COUNT];            //    x    |        |        |
+  uint8_t    bmsMinVoltageCellNumber[BMS_DEVICES_COUNT];            //    x    |        |        |
+  uint8_t    bmsIsBalancingActive[BMS_DEVICES_COUNT];               //    x    |        |        |
+  int16_t    bmsBalancingCurrent[BMS_DEVICES_COUNT];                //    x    |        |        |
+  int16_t    bmsTemperature[BMS_DEVICES_COUNT][3];                  //    2    |   3    |   3    |
+  uint8_t    bmsChargePercentage[BMS_DEVICES_COUNT];                //         |   x    |   x    |
+  uint32_t   bmsErrors[BMS_DEVICES_COUNT];                          //    *    |   x    |   x    |
+  unsigned long bmsLastDataMillis[BMS_DEVICES_COUNT];               //    x    |   x    |   x    |
+  //                                                                // *=Teilweise
 
   //Inverter
   int16_t    inverterVoltage;
@@ -44,10 +67,22 @@ struct data_s
   char       bscIpAdr[16];
   uint8_t    bscRelais;
   uint8_t    displayTimeout;
+
+  struct dataDirty_s dirty;
 };
 
 
-struct data_s * getData();
+//Anzeige (Leser)
+struct data_s * getData();          //Zuletzt übernommener Snapshot, nur lesen
+bool acquireData();                 //Neuesten veröffentlichten Snapshot übernehmen; true wenn neu
+uint32_t getDataGeneration();       //Generation des übernommenen Snapshots (0 = noch keine Daten)
+uint32_t getPublishedGeneration();  //Generation des zuletzt veröffentlichten Zyklus
+void setDisplayedGeneration(uint32_t u32_lGen);  //Generation, die gerade angezeigt wird
+uint32_t getDisplayedGeneration();
+
+//I2C (Schreiber)
+struct data_s * getStagingData();   //Arbeitspuffer für den Empfang
+void publishData();                 //Arbeitspuffer veröffentlichen (Zyklusende)
 
 
 #endif
\ No newline at end of file
@@ -13,18 +13,111 @@
 //Serial
 #define SERIAL_BMS_DEVICES_COUNT     3
 
+/*
+ * Topologie: Die Anzahl der BMS bestimmt Datenmodell, Dekoder und Spalten der Tabs.
+ * Spaltenpositionen werden daraus in display.cpp zur Compilezeit berechnet.
+ */
+#define BMS_DEVICES_COUNT            (BT_DEVICES_COUNT+SERIAL_BMS_DEVICES_COUNT)   //Max. 8 (Bitmasken im I2C-Statusregister)
+#define BMS_CELLS_MAX               24   //Zellen je BMS im Protokoll (BMS_CELL_VOLTAGE), nicht ändern
+#define DISP_CELL_COUNT             16   //Angezeigte Zellen je BMS im Tab Zellspannungen (1..BMS_CELLS_MAX)
+
+
+//Tasks: I2C-Empfang und Dekodierung auf einem Kern, LVGL auf dem anderen
+#define TASK_CORE_I2C           0   //Wire-Slave-Interrupt auf dem Kern, der I2C.begin() aufruft; Callbacks im Slave-Task des Wire-Treibers
+#define TASK_CORE_DISPLAY       1   //Kern der Arduino loop(); bleibt frei von I2C-Interrupts
+#define TASK_PRIO_I2C           4
+#define TASK_PRIO_DISPLAY       5
+//#define TASK_MEASURE_LATENCY      //Histogramme (Wire-Callback->i2c-Task, Verspätung der Display-Schleife) zyklisch über Serial ausgeben
+#define TASK_LATENCY_PRINT_MS 10000
+#define LAT_HIST_BUCKETS       16   //Zweierpotenz-Buckets in us (siehe latency.h), der letzte ab 16 ms
+//#define TRACE_ENABLE              //Trace-Ring (trace.h); Ausgabe über Serial mit 't'
+#define TRACE_RING_SIZE      1024   //Ereignisse im Trace-Ring (8 Bytes je Ereignis); Zweierpotenz
+
+
+//Display
+#define DISP_BUF_LINES         40   //Zeilen je Zeichenpuffer (2 Puffer im DMA-fähigen internen RAM)
+//#define DISP_MEASURE_FLUSH        //Render-/Flushzeiten je Refresh über Serial ausgeben
+//#define DISP_TILE_DIFF            //Nur Kacheln übertragen, deren Inhalt sich gegenüber dem Panel geändert hat
+#define DISP_TILE_W            32   //Kachelgröße für DISP_TILE_DIFF
+#define DISP_TILE_H            20   //DISP_BUF_LINES muss ein Vielfaches sein
+#define DISP_SLEEP_POLL_MS    100   //Touch-Abfrageintervall, solange das Panel schläft
+#define DISP_SUSPECT_MAX        5   //Max. Zyklen mit Lücken in Folge, die nicht gezeichnet werden
+#define DISP_DIAG_PERIOD_MS  1000   //Aktualisierung des Diagnosefelds im Tab Info
+#define DISP_LV_MEM_RESERVE_PCT 50  //Min. freier LVGL-Heap nach dem Aufbau aller Tabs (Größe: lv_conf.h bzw. PSRAM), sonst Warnung
+
 
 //i2c
 #define I2C_DEV_ADDR    0x55
 #define I2C_PIN_SDA        4
 #define I2C_PIN_SCL        2
 
+#define I2C_RX_FRAME_MAX       128  //Max. Länge eines Frames (Slotgröße im Empfangsring)
+#define I2C_RX_RING_SIZE        32  //Anzahl Slots im Empfangsring; Zweierpotenz <= 128
+#define I2C_SNAPSHOT_MAX      1536  //Max. Länge eines Snapshots (SNAPSHOT_DATA)
+//#define I2C_CAPTURE               //Alle empfangenen Frames binär über Serial mitschneiden (Format siehe i2c.h)
+
 
 #define RXBUFF_OFFSET                     0x04
 
 #define BMS_DATA                          0x01  //BMS-Daten
 #define INVERTER_DATA                     0x02  //Inverter-Daten
 #define BSC_DATA                          0x03  //
+#define BATCH_DATA                        0x04  //Sammelframe, siehe unten
+#define SNAPSHOT_DATA                     0x05  //Teil eines vollständigen Snapshots, siehe unten
+
+/*
+ * Sammelframe (nur wenn das Display I2C_CAP_BATCH meldet):
+ *   BATCH_DATA | Gruppe | BMS-Nr | 0 | {ID | Länge | Länge Bytes Wert}...
+ * Alle Datensätze gehören zu derselben Gruppe und demselben BMS.
+ * Der BSC liest die Fähigkeiten per I2C-Read: I2C_PROTO_ID | I2C_PROTO_VERSION | Fähigkeiten.
+ * Alte BSC-Firmware liest nie und sendet weiter einzelne Frames; diese bleiben immer gültig.
+ */
+#define I2C_PROTO_ID                      0xB5
+#define I2C_PROTO_VERSION                 0x02
+#define I2C_CAP_BATCH                     0x01
+#define I2C_CAP_CELL_DELTA                0x02
+#define I2C_CAP_CRC                       0x04
+#define I2C_CAP_SNAPSHOT                  0x08
+#define BATCH_RECORD_HDR                  2
+
+/*
+ * Zellspannungen als Delta (BMS_CELL_VOLTAGE_DELTA, nur bei I2C_CAP_CELL_DELTA):
+ *   u16 Prüfsumme der Basis | u24 Maske geänderter Zellen | je gesetztem Bit ein int8 Delta in mV
+ * Basis sind die zuletzt übernommenen Zellspannungen, Prüfsumme Fletcher-16 über die 48 Bytes.
+ * Passt die Prüfsumme nicht oder fehlt die Basis, wird das Delta verworfen und das BMS in
+ * Byte 3 der Fähigkeiten-Antwort (Bit n = BMS n) als "vollständigen Frame senden" gemeldet.
+ */
+#define CELL_DELTA_HDR                    5
+
+/*
+ * Gesicherte Frames (nur bei I2C_CAP_CRC): Bit 7 im Header-Byte 3 gesetzt, Bit 0..6 laufende Nummer,
+ * letztes Byte CRC-8 (Polynom 0x07 wie SMBus-PEC, Startwert 0) über alle Bytes davor.
+ * Gilt für Einzel- und Sammelframes; ungesicherte Frames (Byte 3 = 0) werden weiter angenommen.
+ */
+#define I2C_FRAME_SEQ_CRC                 0x80
+#define I2C_FRAME_SEQ_MASK                0x7F
+
+/*
+ * Snapshot (nur bei I2C_CAP_SNAPSHOT), z.B. nach dem Start des BSC oder des Displays:
+ *   je Frame SNAPSHOT_DATA | Teil-Nr | Anzahl Teile | 0 | Daten
+ *   Teil 0 beginnt mit der Gesamtlänge (u16), die Daten aller Teile ergeben hintereinander
+ *   {Gruppe | ID | BMS-Nr | Länge | Länge Bytes Wert}...
+ * Übernommen und veröffentlicht wird erst, wenn alle Teile lückenlos da sind; er schließt einen Zyklus ab.
+ * Ein unbekanntes Feld, eine ungültige BMS-Nr oder eine zu kurze Länge verwirft den ganzen Snapshot.
+ */
+#define SNAPSHOT_RECORD_HDR               4
+
+/*
+ * Statusregister (I2C-Read), Little Endian; Leser mit weniger Bytes bekommen unverändert den Anfang:
+ *   0 I2C_PROTO_ID | 1 I2C_PROTO_VERSION | 2 Fähigkeiten | 3 vollständige Zellframes anfordern (Bit n = BMS n)
+ *   4 Status (I2C_STATUS_*) | 5..8 u32 zuletzt gezeichnete Generation (Zyklen seit dem Start des Displays;
+ *     bleibt bei Schlaf und gestörten Zyklen stehen, auch wenn der Empfang schon weiter ist)
+ *   9..10 u16 verworfene Frames | 11..12 u16 Überläufe des Empfangsrings (beide bleiben bei 0xFFFF stehen)
+ */
+#define I2C_STATUS_LEN                    13
+#define I2C_STATUS_SLEEPING               0x01  //Panel aus; der BSC kann Updates aussetzen
+#define I2C_STATUS_SNAPSHOT               0x02  //Bitte einen Snapshot senden (Start, Aufwachen, Überlauf, Lücken)
+#define I2C_STATUS_BUSY                   0x04  //Empfangsring mehr als halb voll; langsamer senden
 
 //BMSDATA 0x01
 #define BMS_CELL_VOLTAGE                  0x01  
@@ -41,6 +134,7 @@
 #define BMS_TEMPERATURE                   0x0C
 #define BMS_CHARGE_PERCENT                0x0D
 #define BMS_ERRORS                        0x0E
+#define BMS_CELL_VOLTAGE_DELTA            0x0F
 
 //INVERTER_DATA 0x02
 #define INVERTER_VOLTAGE                  0x01 
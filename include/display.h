@@ -6,9 +6,66 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <stdint.h>
+#include "latency.h"
+
+//Tabs (Reihenfolge wie in createScreens())
+#define TAB_HOME        0
+#define TAB_SER_BMS     1
+#define TAB_BT_BMS      2
+#define TAB_ZELL_SPG    3
+#define TAB_INFO        4
+#define TAB_COUNT       5
+
+//Startphasen (displayStats_s.u32_bootMs)
+#define BOOT_LCD_INIT     0
+#define BOOT_LVGL_INIT    1
+#define BOOT_HOME_BUILT   2   //Tabview und Tab Home aufgebaut
+#define BOOT_FIRST_FLUSH  3   //Erstes vollständiges Bild übertragen
+#define BOOT_FIRST_DATA   4   //Erster gültiger Zyklus gezeichnet
+#define BOOT_ALL_TABS     5   //Alle Tabs aufgebaut
+#define BOOT_PHASE_COUNT  6
+
+
+struct displayStats_s
+{
+  uint32_t u32_displayedGen;    //Generation der zuletzt gezeichneten Daten
+  uint32_t u32_cyclesDrawn;     //Gezeichnete Zyklen
+  uint32_t u32_cyclesSkipped;   //Zusammengefasste (übersprungene) Zyklen
+  uint32_t u32_cyclesSuspect;   //Nicht gezeichnete Zyklen mit CRC-Fehlern oder Lücken
+  uint32_t u32_firstDrawMs;     //millis() beim ersten gezeichneten Zyklus (0 = noch keiner)
+  uint32_t u32_bootMs[BOOT_PHASE_COUNT];   //millis() je Startphase (0 = noch nicht erreicht)
+  uint32_t u32_pxPushed;        //Zum Panel übertragene Pixel
+  uint32_t u32_pxSkipped;       //Nicht übertragene Pixel, weil die Kachel unverändert war (DISP_TILE_DIFF)
+  uint32_t u32_refreshes;       //Abgeschlossene LVGL-Refreshes
+  uint32_t u32_flushUs;         //Summe der Zeit im Flush-Callback
+  uint32_t u32_lvglUs;          //Summe der Zeit in lv_timer_handler() (Rendern und Flush)
+  struct latHist_s loopLate;    //Verspätung von displayRunCyclic() gegenüber der zuletzt gemeldeten Wartezeit
+  struct latHist_s lvglRun;     //Laufzeit von lv_timer_handler()
+};
+
+
+//LVGL-Heap (lv_mem); Belegung je Tab beim Aufbau der Objekte
+struct displayMemStats_s
+{
+  uint32_t u32_heapSize;        //Größe des LVGL-Heaps (LV_MEM_CUSTOM: belegt + frei im PSRAM)
+  uint32_t u32_heapUsed;        //Aktuell belegt
+  uint32_t u32_heapInternal;    //Davon im internen RAM (mit PSRAM: Renderpuffer und Ausweichblöcke)
+  uint32_t u32_heapPeak;        //Max. belegt seit dem Start
+  uint32_t u32_heapBiggest;     //Größter freier Block
+  uint8_t  u8_heapFrag;         //Fragmentierung in %
+  uint32_t u32_baseBytes;       //Tabview und Styles
+  uint32_t u32_tabBytes[TAB_COUNT];     //Aufbau je Tab: belegte Bytes
+  uint16_t u16_tabAllocs[TAB_COUNT];    //Aufbau je Tab: belegte Blöcke
+};
+
+
 void displayInit();
-void displayRunCyclic();
+uint32_t displayRunCyclic();
 void displayNewBscData();
+bool displayIsSleeping();
+void getDisplayStats(struct displayStats_s *stats);
+void getDisplayMemStats(struct displayMemStats_s *stats);
 
 
 
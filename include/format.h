@@ -0,0 +1,26 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdint.h>
+
+/*
+ * Formatierung der ganzzahligen Messwerte (z.B. 10mV, 100mA, mV) ohne Float und ohne Heap.
+ * Alle Funktionen schreiben ab p in einen vom Aufrufer bereitgestellten Puffer,
+ * terminieren mit '\0' und geben einen Zeiger auf das '\0' zurück, sodass Aufrufe
+ * direkt aneinandergehängt werden können. Der Aufrufer muss genügend Platz vorsehen
+ * (max. 12 Zeichen je Zahl inkl. Vorzeichen und Komma).
+ */
+char *fmtStr(char *p, const char *str);
+char *fmtUInt(char *p, uint32_t u32_lValue);
+char *fmtInt(char *p, int32_t i32_lValue);
+
+//i32_lValue hat u8_lInDecimals Nachkommastellen (z.B. 2 für 10mV); Ausgabe mit u8_lOutDecimals, kaufmännisch gerundet
+char *fmtFixed(char *p, int32_t i32_lValue, uint8_t u8_lInDecimals, uint8_t u8_lOutDecimals);
+
+
+#endif
@@ -6,9 +6,55 @@
 #ifndef I2C_H
 #define I2C_H
 
+#include <Arduino.h>
+#include "latency.h"
+
+
+/*
+ * Mitschnittformat (I2C_CAPTURE): je Frame ein Datensatz, Little Endian
+ *   0xA5 0x5A | u32 Empfangszeit in us | u8 Länge | Länge Bytes Rohdaten
+ * Die beiden Sync-Bytes erlauben dem Host, sonstige Serial-Ausgaben zu überspringen.
+ */
+#define I2C_CAPTURE_SYNC0     0xA5
+#define I2C_CAPTURE_SYNC1     0x5A
+#define I2C_CAPTURE_HDR_LEN   7
+
+
+struct i2cStats_s
+{
+  uint32_t u32_rxFrames;        //Empfangene Frames
+  uint32_t u32_ringOverflow;    //Verworfene Frames, weil der Empfangsring voll war
+  uint8_t  u8_ringHighWater;    //Max. Füllstand des Empfangsrings
+  uint32_t u32_dropOversize;    //Verworfen: Frame länger als I2C_RX_FRAME_MAX
+  uint32_t u32_dropShort;       //Verworfen: kürzer als der Header
+  uint32_t u32_dropUnknown;     //Verworfen: unbekannte Gruppe/ID
+  uint32_t u32_dropBmsNr;       //Verworfen: BMS-Nummer außerhalb
+  uint32_t u32_dropPayload;     //Verworfen: Nutzdaten kürzer als das Feld
+  uint32_t u32_cyclesLegacy;    //Zyklen nur aus Einzelframes
+  uint32_t u32_framesLegacy;    //  I2C-Transaktionen darin
+  uint32_t u32_bytesLegacy;     //  Bytes darin (ohne Adressbyte)
+  uint32_t u32_cyclesBatch;     //Zyklen mit Sammelframes
+  uint32_t u32_framesBatch;
+  uint32_t u32_bytesBatch;
+  uint32_t u32_cellDeltas;      //Übernommene Delta-Frames der Zellspannungen
+  uint32_t u32_cellDeltaMismatch; //Verworfene Delta-Frames (Basis fehlt/Prüfsumme falsch)
+  uint32_t u32_crcErrors;       //Gesicherte Frames mit falscher CRC
+  uint32_t u32_seqGaps;         //Fehlende Frames laut laufender Nummer
+  uint32_t u32_cyclesSuspect;   //Veröffentlichte Zyklen mit CRC-Fehlern oder Lücken
+  uint32_t u32_snapshots;       //Übernommene Snapshots
+  uint32_t u32_snapshotAborted; //Verworfene Snapshots (Teil fehlt, Länge falsch)
+  struct latHist_s rxWake;      //onReceive() (Wire-Slave-Task) bis der i2c-Task den Frame aufnimmt
+  uint32_t u32_stackFree;       //Min. freier Stack des i2c-Tasks in Bytes
+};
+
 
-bool hasNewDisplayData();
 void initI2C();
+void i2cSetNotifyTask(TaskHandle_t task);   //Task, der bei jedem abgeschlossenen Zyklus benachrichtigt wird
+void i2cProcessRxFrames();
+void getI2cStats(struct i2cStats_s *stats);
+void i2cRequestSnapshot();                  //Beim nächsten Lesen des Statusregisters einen Snapshot anfordern
+uint16_t i2cCellChecksum(const uint16_t *cells);   //Prüfsumme der Basis für BMS_CELL_VOLTAGE_DELTA
+uint8_t i2cCrc8(const uint8_t *data, uint8_t u8_lLen);   //CRC gesicherter Frames (I2C_FRAME_SEQ_CRC)
   
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,29 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include "defines.h"
+
+/*
+ * Histogramm für Laufzeiten in us mit Zweierpotenz-Buckets:
+ * Bucket 0 = 0 us, Bucket b = [2^(b-1), 2^b) us, der letzte Bucket nimmt alle größeren Werte auf.
+ * Ein Schreiber, beliebige Leser; gelesene Werte können um einen Eintrag veraltet sein.
+ */
+struct latHist_s
+{
+  uint32_t u32_count[LAT_HIST_BUCKETS];
+  uint32_t u32_maxUs;
+};
+
+
+void latHistAdd(struct latHist_s *hist, uint32_t u32_lUs);
+uint32_t latHistPercentile(const struct latHist_s *hist, uint16_t u16_lPermille);   //Obergrenze (exklusiv) des Buckets in us
+void latHistPrint(const char *name, const struct latHist_s *hist);                  //Eine Zeile über Serial
+
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "defines.h"
+
+/*
+ * Trace-Ring (TRACE_ENABLE): Begin/End-Ereignisse mit Zeitstempel in us und Kern.
+ * Schreiben ist lock-frei (atomare Zähler, auch aus onReceive()); ist der Ring voll,
+ * werden die ältesten Ereignisse überschrieben. traceDump() hält das Schreiben an und wartet,
+ * bis laufende traceRecord() fertig sind, und gibt den Ring als Text über Serial aus:
+ *   #TRACE <Anzahl> <überschrieben>
+ *   #T <us> <Kern> <B|E|I> <Name>
+ *   #TRACE END
+ * Der Host wandelt das mit "program trace <Dump> <json>" in das Chrome-/Perfetto-Format.
+ * Ohne TRACE_ENABLE sind alle Makros leer.
+ */
+enum traceId_e
+{
+  TRACE_I2C_RX,         //onReceive()
+  TRACE_I2C_DECODE,     //processRxData() eines Frames
+  TRACE_I2C_PUBLISH,    //Zyklus veröffentlicht
+  TRACE_DISP_DATA,      //displayNewBscData()
+  TRACE_LVGL,           //lv_timer_handler()
+  TRACE_FLUSH,          //display_flush()
+  TRACE_FLUSH_WAIT,     //display_flush(): Warten auf das Ende des vorherigen DMA-Transfers
+  TRACE_ID_COUNT
+};
+
+#define TRACE_TYPE_BEGIN      'B'
+#define TRACE_TYPE_END        'E'
+#define TRACE_TYPE_INSTANT    'I'
+
+
+#ifdef TRACE_ENABLE
+void traceRecord(uint8_t u8_lId, uint8_t u8_lType);
+void traceDump();
+
+#define TRACE_BEGIN(id)       traceRecord(id, TRACE_TYPE_BEGIN)
+#define TRACE_END(id)         traceRecord(id, TRACE_TYPE_END)
+#define TRACE_INSTANT(id)     traceRecord(id, TRACE_TYPE_INSTANT)
+#else
+#define TRACE_BEGIN(id)
+#define TRACE_END(id)
+#define TRACE_INSTANT(id)
+#endif
+
+
+#endif
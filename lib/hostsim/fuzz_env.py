@@ -0,0 +1,5 @@
+# libFuzzer gibt es nur mit clang; Compiler umstellen und Sanitizer auch beim Linken einbinden
+Import("env")
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+env.Append(LINKFLAGS=["-fsanitize=fuzzer,address,undefined"])
@@ -0,0 +1,4 @@
+# Sanitizer-Laufzeit auch beim Linken einbinden (build_flags gelten nur für den Compiler)
+Import("env")
+
+env.Append(LINKFLAGS=["-fsanitize=address,undefined"])
@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "Arduino.h"
+#include <time.h>
+
+
+HardwareSerial Serial;
+
+static uint64_t u64_mStartUs = 0;
+
+
+static uint64_t monotonicUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000ULL + ts.tv_nsec/1000;
+}
+
+
+unsigned long micros()
+{
+  if(u64_mStartUs==0) u64_mStartUs=monotonicUs();
+  return (unsigned long)(monotonicUs()-u64_mStartUs);
+}
+
+
+unsigned long millis()
+{
+  return micros()/1000;
+}
+
+
+size_t HardwareSerial::printf(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int len = vprintf(fmt, args);
+  va_end(args);
+  return (len<0) ? 0 : len;
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  static int i_mDummy;
+  return &i_mDummy;
+}
+
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+  (void)task;
+}
+
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+  (void)clearOnExit;
+  (void)ticks;
+  return 0;
+}
+
+
+void vTaskDelay(TickType_t ticks)
+{
+  (void)ticks;
+}
+
+
+BaseType_t xPortGetCoreID()
+{
+  return 0;
+}
+
+
+uint32_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  (void)task;
+  return 0;
+}
+
+
+BaseType_t xTaskCreate(void (*fn)(void *), const char *name, uint32_t stack, void *param, uint32_t prio, TaskHandle_t *handle)
+{
+  //Tasks laufen auf dem Host nicht; der Host-Treiber ruft die Funktionen direkt auf
+  (void)fn; (void)name; (void)stack; (void)param; (void)prio;
+  if(handle!=NULL) *handle=NULL;
+  return pdPASS;
+}
+
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+  (void)caps;
+  return malloc(size);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+ * Host-Ersatz für Arduino/ESP-IDF/FreeRTOS (env:native).
+ * Es gibt nur einen Thread: Task-Benachrichtigungen blockieren nie, der Host-Treiber
+ * (hostMain.cpp) ruft I2C-Empfang, Dekodierung und Anzeige der Reihe nach auf.
+ */
+
+#ifndef HOSTSIM_ARDUINO_H
+#define HOSTSIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+
+
+//FreeRTOS
+typedef void * TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdTRUE                 1
+#define pdFALSE                0
+#define pdPASS                 1
+#define portMAX_DELAY          0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms)      ((TickType_t)(ms))
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xPortGetCoreID();
+uint32_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t xTaskCreate(void (*fn)(void *), const char *name, uint32_t stack, void *param, uint32_t prio, TaskHandle_t *handle);
+
+
+//ESP-IDF heap_caps
+#define MALLOC_CAP_DMA         (1<<3)
+#define MALLOC_CAP_8BIT        (1<<2)
+#define MALLOC_CAP_SPIRAM      (1<<10)
+#define MALLOC_CAP_INTERNAL    (1<<11)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+
+
+//Serial (Ausgabe nach stdout)
+class HardwareSerial
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t *buf, size_t len) { return fwrite(buf, 1, len, stdout); }
+  size_t print(const char *str) { return printf("%s", str); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t println(const char *str) { return printf("%s\n", str); }
+  size_t println(long v) { return printf("%ld\n", v); }
+  size_t println(bool v) { return printf("%d\n", v ? 1 : 0); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  int available() { return 0; }
+  int read() { return -1; }
+  void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "LovyanGFX.hpp"
+
+
+static uint16_t u16_mFb[HOSTSIM_LCD_WIDTH*HOSTSIM_LCD_HEIGHT];
+static uint64_t u64_mPixelsPushed = 0;
+static bool bo_mTouchPressed = false;
+static uint16_t u16_mTouchX = 0;
+static uint16_t u16_mTouchY = 0;
+
+
+bool LGFX::init()
+{
+  memset(u16_mFb, 0, sizeof(u16_mFb));
+  return true;
+}
+
+
+void LGFX::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+  winX0=x;
+  winY0=y;
+  winX1=x+w-1;
+  winY1=y+h-1;
+  curX=x;
+  curY=y;
+}
+
+
+void LGFX::pushPixels(const uint16_t *data, int32_t len, bool swap)
+{
+  for(int32_t i=0;i<len;i++)
+  {
+    if(curY>winY1) break;
+    uint16_t px = data[i];
+    if(swap) px = (uint16_t)((px<<8)|(px>>8));
+    if(curX>=0 && curX<HOSTSIM_LCD_WIDTH && curY>=0 && curY<HOSTSIM_LCD_HEIGHT) u16_mFb[curY*HOSTSIM_LCD_WIDTH+curX]=px;
+    if(++curX>winX1)
+    {
+      curX=winX0;
+      curY++;
+    }
+  }
+  u64_mPixelsPushed+=len;
+}
+
+
+void LGFX::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::rgb565_t *data)
+{
+  setAddrWindow(x, y, w, h);
+  pushPixels(&data->raw, w*h, true);
+}
+
+
+void LGFX::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t *data)
+{
+  setAddrWindow(x, y, w, h);
+  pushPixels(&data->raw, w*h, false);
+}
+
+
+bool LGFX::getTouch(uint16_t *x, uint16_t *y)
+{
+  if(!bo_mTouchPressed) return false;
+  *x=u16_mTouchX;
+  *y=u16_mTouchY;
+  return true;
+}
+
+
+const uint16_t *LGFX::framebuffer()
+{
+  return u16_mFb;
+}
+
+
+uint64_t LGFX::pixelsPushed()
+{
+  return u64_mPixelsPushed;
+}
+
+
+void LGFX::touch(bool pressed, uint16_t x, uint16_t y)
+{
+  bo_mTouchPressed=pressed;
+  u16_mTouchX=x;
+  u16_mTouchY=y;
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+ * Host-Ersatz für LovyanGFX: Panel 480x320 RGB565 im RAM.
+ * Pixel werden wie auf dem Bus in Panel-Bytereihenfolge (big endian) abgelegt.
+ * DMA-Transfers werden synchron ausgeführt.
+ */
+
+#ifndef HOSTSIM_LOVYANGFX_HPP
+#define HOSTSIM_LOVYANGFX_HPP
+
+#include "Arduino.h"
+
+#define HOSTSIM_LCD_WIDTH   480
+#define HOSTSIM_LCD_HEIGHT  320
+
+namespace lgfx
+{
+  struct rgb565_t  { uint16_t raw; };   //Host-Bytereihenfolge, wird beim Übertragen getauscht
+  struct swap565_t { uint16_t raw; };   //Bereits in Panel-Bytereihenfolge
+}
+
+
+class LGFX
+{
+public:
+  bool init();
+  int32_t width() { return (u8_rotation&1) ? HOSTSIM_LCD_HEIGHT : HOSTSIM_LCD_WIDTH; }
+  int32_t height() { return (u8_rotation&1) ? HOSTSIM_LCD_WIDTH : HOSTSIM_LCD_HEIGHT; }
+  uint8_t getRotation() { return u8_rotation; }
+  void setRotation(uint8_t r) { u8_rotation=r&3; }
+
+  void startWrite() { i_startCount++; }
+  void endWrite() { if(i_startCount>0) i_startCount--; }
+  int getStartCount() { return i_startCount; }
+
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushPixels(const uint16_t *data, int32_t len, bool swap);
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::rgb565_t *data);
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t *data);
+  void waitDMA() {}
+  bool dmaBusy() { return false; }
+
+  bool getTouch(uint16_t *x, uint16_t *y);
+  void sleep() { bo_sleeping=true; }
+  void wakeup() { bo_sleeping=false; }
+
+  //Host
+  static const uint16_t *framebuffer();
+  static uint64_t pixelsPushed();
+  static void touch(bool pressed, uint16_t x, uint16_t y);
+
+private:
+  uint8_t u8_rotation = 0;
+  int i_startCount = 0;
+  bool bo_sleeping = false;
+  int32_t winX0 = 0, winY0 = 0, winX1 = 0, winY1 = 0;
+  int32_t curX = 0, curY = 0;
+};
+
+
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "Wire.h"
+
+
+bool TwoWire::begin(uint8_t addr, int sda, int scl, uint32_t freq)
+{
+  (void)addr; (void)sda; (void)scl; (void)freq;
+  return true;
+}
+
+
+void TwoWire::onReceive(void (*cb)(int))
+{
+  rxCb=cb;
+}
+
+
+void TwoWire::onRequest(void (*cb)(void))
+{
+  reqCb=cb;
+}
+
+
+int TwoWire::available()
+{
+  return (int)(rxLen-rxPos);
+}
+
+
+int TwoWire::read()
+{
+  if(rxPos>=rxLen) return -1;
+  return u8_rxBuf[rxPos++];
+}
+
+
+size_t TwoWire::write(uint8_t c)
+{
+  if(txLen>=HOSTSIM_WIRE_BUF_SIZE) return 0;
+  u8_txBuf[txLen++]=c;
+  return 1;
+}
+
+
+size_t TwoWire::write(const uint8_t *buf, size_t len)
+{
+  size_t n=0;
+  while(n<len && write(buf[n])) n++;
+  return n;
+}
+
+
+void TwoWire::inject(const uint8_t *data, size_t len)
+{
+  if(len>HOSTSIM_WIRE_BUF_SIZE) len=HOSTSIM_WIRE_BUF_SIZE;
+  memcpy(u8_rxBuf, data, len);
+  rxLen=len;
+  rxPos=0;
+  if(rxCb!=NULL) rxCb((int)len);
+  rxLen=0;
+  rxPos=0;
+}
+
+
+size_t TwoWire::request(uint8_t *data, size_t maxLen)
+{
+  txLen=0;
+  if(reqCb!=NULL) reqCb();
+  size_t n = (txLen<maxLen) ? txLen : maxLen;
+  memcpy(data, u8_txBuf, n);
+  return n;
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef HOSTSIM_WIRE_H
+#define HOSTSIM_WIRE_H
+
+#include "Arduino.h"
+
+#define HOSTSIM_WIRE_BUF_SIZE   256
+
+
+//I2C-Slave; Frames werden über inject() eingespeist und wie vom Treiber an onReceive() gemeldet
+class TwoWire
+{
+public:
+  TwoWire(uint8_t bus) : u8_bus(bus) {}
+
+  bool begin(uint8_t addr, int sda, int scl, uint32_t freq);
+  void onReceive(void (*cb)(int));
+  void onRequest(void (*cb)(void));
+  int available();
+  int read();
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t len);
+
+  //Host: Frame empfangen (ruft den onReceive-Callback auf)
+  void inject(const uint8_t *data, size_t len);
+  //Host: Master liest; ruft den onRequest-Callback auf und liefert die geschriebenen Bytes
+  size_t request(uint8_t *data, size_t maxLen);
+
+private:
+  uint8_t u8_bus;
+  void (*rxCb)(int) = NULL;
+  void (*reqCb)(void) = NULL;
+  uint8_t u8_rxBuf[HOSTSIM_WIRE_BUF_SIZE];
+  size_t rxLen = 0;
+  size_t rxPos = 0;
+  uint8_t u8_txBuf[HOSTSIM_WIRE_BUF_SIZE];
+  size_t txLen = 0;
+};
+
+
+#endif
@@ -0,0 +1,135 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "hostCapture.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <LovyanGFX.hpp>
+#include <lvgl.h>
+#include <unistd.h>
+#include "defines.h"
+#include "data.h"
+#include "i2c.h"
+#include "display.h"
+
+extern TwoWire I2C;
+
+
+bool captureWrite(FILE *f, uint32_t u32_lMicros, const uint8_t *data, uint8_t u8_lLen)
+{
+  uint8_t u8_lHdr[I2C_CAPTURE_HDR_LEN] = {I2C_CAPTURE_SYNC0, I2C_CAPTURE_SYNC1,
+    (uint8_t)u32_lMicros, (uint8_t)(u32_lMicros>>8), (uint8_t)(u32_lMicros>>16), (uint8_t)(u32_lMicros>>24), u8_lLen};
+
+  if(fwrite(u8_lHdr, 1, I2C_CAPTURE_HDR_LEN, f)!=I2C_CAPTURE_HDR_LEN) return false;
+  return fwrite(data, 1, u8_lLen, f)==u8_lLen;
+}
+
+
+//Bis zum nächsten Sync suchen; sonstige Serial-Ausgaben im Mitschnitt werden übersprungen
+bool captureRead(FILE *f, uint32_t *u32_lMicros, uint8_t *data, uint8_t *u8_lLen)
+{
+  int c, prev=-1;
+
+  for(;;)
+  {
+    c=fgetc(f);
+    if(c==EOF) return false;
+    if(prev==I2C_CAPTURE_SYNC0 && c==I2C_CAPTURE_SYNC1) break;
+    prev=c;
+  }
+
+  uint8_t u8_lHdr[I2C_CAPTURE_HDR_LEN-2];
+  if(fread(u8_lHdr, 1, sizeof(u8_lHdr), f)!=sizeof(u8_lHdr)) return false;
+  *u32_lMicros = u8_lHdr[0] | (u8_lHdr[1]<<8) | (u8_lHdr[2]<<16) | ((uint32_t)u8_lHdr[3]<<24);
+  *u8_lLen = u8_lHdr[4];
+  return fread(data, 1, *u8_lLen, f)==*u8_lLen;
+}
+
+
+int replayCapture(const char *fileName, uint32_t u32_lSpeed)
+{
+  FILE *f=fopen(fileName, "rb");
+  if(f==NULL)
+  {
+    Serial.printf("replay: cannot open %s\n", fileName);
+    return 1;
+  }
+
+  uint8_t u8_lData[255];
+  uint8_t u8_lLen;
+  uint32_t u32_lTs, u32_lTsPrev=0;
+  uint64_t u64_lCapUs=0;           //Zeit im Mitschnitt seit dem ersten Frame
+  uint32_t u32_lFrames=0, u32_lCycles=0;
+  uint32_t u32_lCycleStart=0;
+  bool bo_lCycleOpen=false;
+  uint64_t u64_lLatSum=0, u64_lSpanSum=0;
+  uint32_t u32_lLatMax=0, u32_lSpanMax=0;
+  uint32_t u32_lDecodeUs=0, u32_lRenderUs=0;
+  uint32_t u32_lGen=getPublishedGeneration();
+
+  uint32_t u32_lStart=micros();
+
+  while(captureRead(f, &u32_lTs, u8_lData, &u8_lLen))
+  {
+    if(u32_lFrames==0) u32_lTsPrev=u32_lTs;
+    u64_lCapUs += (uint32_t)(u32_lTs-u32_lTsPrev);
+    u32_lTsPrev = u32_lTs;
+
+    //Im Takt des Mitschnitts einspeisen
+    if(u32_lSpeed>0)
+    {
+      uint64_t u64_lDue = u64_lCapUs/u32_lSpeed;
+      uint32_t u32_lNow = micros()-u32_lStart;
+      if(u64_lDue>u32_lNow) usleep((useconds_t)(u64_lDue-u32_lNow));
+    }
+
+    uint32_t u32_lArrival=micros();
+    if(!bo_lCycleOpen)
+    {
+      u32_lCycleStart=u32_lArrival;
+      bo_lCycleOpen=true;
+    }
+
+    I2C.inject(u8_lData, u8_lLen);
+    i2cProcessRxFrames();
+    u32_lFrames++;
+    u32_lDecodeUs += micros()-u32_lArrival;
+
+    //Zyklusende: zeichnen und Latenz vom letzten Frame des Zyklus bis zum Ende des Flush messen (Dekodierung,
+    //Veröffentlichen, Zeichnen). Die Sendedauer des BSC vom ersten bis zum letzten Frame wird getrennt erfasst.
+    //Erkannt an einer neu veröffentlichten Generation, damit auch Sammel-, CRC- und Snapshot-Frames passen.
+    if(getPublishedGeneration()!=u32_lGen)
+    {
+      u32_lGen=getPublishedGeneration();
+      uint32_t u32_lT=micros();
+      displayNewBscData();
+      lv_refr_now(NULL);
+      uint32_t u32_lEnd=micros();
+      u32_lRenderUs += u32_lEnd-u32_lT;
+
+      uint32_t u32_lLat=u32_lEnd-u32_lArrival;
+      u64_lLatSum+=u32_lLat;
+      if(u32_lLat>u32_lLatMax) u32_lLatMax=u32_lLat;
+      uint32_t u32_lSpan=u32_lArrival-u32_lCycleStart;
+      u64_lSpanSum+=u32_lSpan;
+      if(u32_lSpan>u32_lSpanMax) u32_lSpanMax=u32_lSpan;
+      u32_lCycles++;
+      bo_lCycleOpen=false;
+    }
+  }
+  fclose(f);
+
+  uint32_t u32_lWallUs=micros()-u32_lStart;
+
+  Serial.printf("replay:  %u frames, %u cycles, capture %.3f s, wall %.3f s (speed %u%s)\n", u32_lFrames, u32_lCycles,
+    u64_lCapUs/1e6, u32_lWallUs/1e6, u32_lSpeed, (u32_lSpeed==0) ? " = max" : "x");
+  Serial.printf("decode:  %.0f frames/s\n", u32_lFrames*1e6/(u32_lDecodeUs ? u32_lDecodeUs : 1));
+  Serial.printf("render:  %.1f cycles/s\n", u32_lCycles*1e6/(u32_lRenderUs ? u32_lRenderUs : 1));
+  Serial.printf("latency: last frame -> flushed avg %.1f us, max %u us\n",
+    (u32_lCycles>0) ? (double)u64_lLatSum/u32_lCycles : 0.0, u32_lLatMax);
+  Serial.printf("span:    first -> last frame of a cycle avg %.1f us, max %u us\n",
+    (u32_lCycles>0) ? (double)u64_lSpanSum/u32_lCycles : 0.0, u32_lSpanMax);
+  return 0;
+}
@@ -0,0 +1,21 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef HOSTSIM_HOSTCAPTURE_H
+#define HOSTSIM_HOSTCAPTURE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+//Lesen/Schreiben von I2C-Mitschnitten (Format siehe i2c.h, I2C_CAPTURE)
+bool captureWrite(FILE *f, uint32_t u32_lMicros, const uint8_t *data, uint8_t u8_lLen);
+bool captureRead(FILE *f, uint32_t *u32_lMicros, uint8_t *data, uint8_t *u8_lLen);
+
+//Mitschnitt durch Empfang, Dekodierung und Anzeige abspielen.
+//u32_lSpeed: 1 = Echtzeit, N = N-fach, 0 = so schnell wie möglich
+int replayCapture(const char *fileName, uint32_t u32_lSpeed);
+
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+ * libFuzzer-Ziel für den I2C-Dekoder (env:native_fuzz).
+ * Die Eingabe wird als Folge von Frames gelesen: 1 Byte Länge, danach die Frame-Bytes.
+ * Jeder Frame läuft wie auf dem Gerät über onReceive() in den Empfangsring und
+ * wird mit i2cProcessRxFrames() dekodiert. Beim Beenden werden Durchsatz und
+ * Drop-Zähler ausgegeben.
+ */
+
+#ifdef HOSTSIM_FUZZ
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "defines.h"
+#include "data.h"
+#include "i2c.h"
+
+extern TwoWire I2C;
+
+static bool bo_mInit = false;
+static uint64_t u64_mFrames = 0;
+static uint64_t u64_mDecodeUs = 0;
+
+
+static void printFuzzStats()
+{
+  struct i2cStats_s i2cStats;
+  getI2cStats(&i2cStats);
+
+  Serial.printf("fuzz:    %llu frames in %llu us, %.0f frames/s\n", (unsigned long long)u64_mFrames,
+    (unsigned long long)u64_mDecodeUs, u64_mFrames*1e6/(u64_mDecodeUs ? u64_mDecodeUs : 1));
+  Serial.printf("drops:   oversize %u, short %u, unknown %u, bmsNr %u, payload %u, ring overflow %u\n",
+    i2cStats.u32_dropOversize, i2cStats.u32_dropShort, i2cStats.u32_dropUnknown,
+    i2cStats.u32_dropBmsNr, i2cStats.u32_dropPayload, i2cStats.u32_ringOverflow);
+}
+
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  if(!bo_mInit)
+  {
+    initI2C();
+    atexit(printFuzzStats);
+    bo_mInit=true;
+  }
+
+  uint32_t u32_lStart=micros();
+  size_t pos=0;
+  while(pos<size)
+  {
+    size_t len=data[pos++];
+    if(len>size-pos) len=size-pos;
+    I2C.inject(&data[pos], len);
+    pos+=len;
+    u64_mFrames++;
+
+    //Ring leeren, bevor er überläuft
+    if((u64_mFrames%(I2C_RX_RING_SIZE/2))==0) i2cProcessRxFrames();
+  }
+  i2cProcessRxFrames();
+  u64_mDecodeUs+=micros()-u32_lStart;
+
+  //Leserseite des Dreifachpuffers mit durchlaufen lassen
+  acquireData();
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,167 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+ * Bisheriger switch-Dekoder (vor der Feldtabelle rxFields in i2c.cpp), nur als Vergleich
+ * für den Host-Benchmark. Schreibt in einen eigenen data_s; am Zyklusende wird er
+ * wie in publishData() umkopiert, aber nicht an die Anzeige übergeben.
+ */
+
+#include "hostLegacyDecode.h"
+#include <string.h>
+#include "defines.h"
+#include "data.h"
+
+
+static struct data_s legacyData;
+static struct data_s legacyPublished;
+static uint32_t u32_mLegacyCycles = 0;
+
+
+static inline void updateField(void *dst, const uint8_t *src, uint8_t u8_lLen, uint8_t *u8_lDirty, uint8_t u8_lFlag)
+{
+  if(memcmp(dst, src, u8_lLen)==0) return;
+  memcpy(dst, src, u8_lLen);
+  *u8_lDirty |= u8_lFlag;
+}
+
+
+void legacyProcessRxData(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen)
+{
+  if(u8_lRxBufLen<4) return;
+
+  uint8_t u8_lData0 = i2cRxBuf[0];
+  uint8_t u8_lData1 = i2cRxBuf[1];
+  uint8_t u8_lBmsNr=0;
+
+  switch (u8_lData0)
+  {
+    case BMS_DATA:
+      u8_lBmsNr=i2cRxBuf[2];
+      switch (u8_lData1)
+      {
+        case BMS_CELL_VOLTAGE:
+          updateField(&legacyData.bmsCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 48, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_CELLS);
+          break;
+
+        case BMS_TOTAL_VOLTAGE:
+          updateField(&legacyData.bmsTotalVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_MAX_CELL_DIFFERENCE_VOLTAGE:
+          updateField(&legacyData.bmsMaxCellDifferenceVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_AVG_VOLTAGE:
+          updateField(&legacyData.bmsAvgVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_TOTAL_CURRENT:
+          updateField(&legacyData.bmsTotalCurrent[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_MAX_CELL_VOLTAGE:
+          updateField(&legacyData.bmsMaxCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_MIN_CELL_VOLTAGE:
+          updateField(&legacyData.bmsMinCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_MAX_VOLTAGE_CELL_NUMBER:
+          updateField(&legacyData.bmsMaxVoltageCellNumber[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_MIN_VOLTAGE_CELL_NUMBER:
+          updateField(&legacyData.bmsMinVoltageCellNumber[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_IS_BALANCING_ACTIVE:
+          updateField(&legacyData.bmsIsBalancingActive[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_STATUS);
+          break;
+
+        case BMS_BALANCING_CURRENT:
+          updateField(&legacyData.bmsBalancingCurrent[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_STATUS);
+          break;
+
+        case BMS_TEMPERATURE:
+          updateField(&legacyData.bmsTemperature[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 6, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TEMPS);
+          break;
+
+        case BMS_CHARGE_PERCENT:
+          updateField(&legacyData.bmsChargePercentage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_TOTALS);
+          break;
+
+        case BMS_ERRORS:
+          updateField(&legacyData.bmsErrors[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 4, &legacyData.dirty.u8_bms[u8_lBmsNr], DIRTY_BMS_STATUS);
+          break;
+
+        default:
+          break;
+      }
+      break;
+
+    case INVERTER_DATA:
+      switch (u8_lData1)
+        {
+          case INVERTER_VOLTAGE:
+            updateField(&legacyData.inverterVoltage, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_INVERTER);
+            break;
+          case INVERTER_CURRENT:
+            updateField(&legacyData.inverterCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_INVERTER);
+            break;
+          case INVERTER_SOC:
+            updateField(&legacyData.inverterSoc, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_INVERTER);
+            break;
+          case INVERTER_CHARGE_CURRENT:
+            updateField(&legacyData.inverterChargeCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_INVERTER);
+            break;
+          case INVERTER_DISCHARG_CURRENT:
+            updateField(&legacyData.inverterDischargeCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_INVERTER);
+            break;
+        }
+        break;
+
+    case BSC_DATA:
+      switch (u8_lData1)
+        {
+          case BSC_ALARMS:
+            updateField(&legacyData.bscAlarms, &i2cRxBuf[RXBUFF_OFFSET], 2, &legacyData.dirty.u8_global, DIRTY_BSC_ALARMS);
+            break;
+/*TODO Integrieren mit spezial Display FW
+          case BSC_IP_ADDR:
+            updateField(&legacyData.bscIpAdr, &i2cRxBuf[RXBUFF_OFFSET], 16, &legacyData.dirty.u8_global, DIRTY_BSC_SETTINGS);
+            break;
+ */           
+          case BSC_RELAIS:
+            updateField(&legacyData.bscRelais, &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_global, DIRTY_BSC_RELAIS);
+            break;
+
+          case BSC_DISPLAY_TIMEOUT:
+            updateField(&legacyData.displayTimeout, &i2cRxBuf[RXBUFF_OFFSET], 1, &legacyData.dirty.u8_global, DIRTY_BSC_SETTINGS);
+            //Kosten von publishData() nachbilden, damit beide Dekoder vergleichbar bleiben
+            memcpy(&legacyPublished, &legacyData, sizeof(struct data_s));
+            memset(&legacyData.dirty, 0, sizeof(struct dataDirty_s));
+            u32_mLegacyCycles++;
+            break;
+        }
+        break;
+
+    default:
+      break;
+  }
+}
+
+
+uint32_t legacyDecodeCycles()
+{
+  return u32_mLegacyCycles;
+}
+
+
+const struct data_s *legacyDecodeData()
+{
+  return &legacyPublished;
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef HOSTSIM_HOSTLEGACYDECODE_H
+#define HOSTSIM_HOSTLEGACYDECODE_H
+
+#include <stdint.h>
+
+struct data_s;
+
+//Switch-Dekoder vor rxFields als Vergleichsbasis für den Host-Benchmark (nur Einzelframes)
+void legacyProcessRxData(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen);
+uint32_t legacyDecodeCycles();
+const struct data_s *legacyDecodeData();   //Stand am Ende des letzten Zyklus
+
+
+#endif
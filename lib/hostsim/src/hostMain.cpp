@@ -0,0 +1,619 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+ * Host-Treiber für env:native. Ersetzt setup()/loop() und die FreeRTOS-Tasks aus main.cpp:
+ * speist synthetische BSC-Zyklen über den Wire-Ersatz ein, dekodiert sie mit dem
+ * Originalcode und rendert mit LVGL in den RAM-Framebuffer des LovyanGFX-Ersatzes.
+ *
+ * Aufruf: program [Zyklen]                   synthetische Zyklen, Benchmarks
+ *         program record <Datei> [Zyklen]    synthetische Zyklen als I2C-Mitschnitt speichern
+ *         program replay <Datei> [Tempo]     Mitschnitt abspielen; Tempo 1 = Echtzeit, N = N-fach, 0 = max.
+ *         program startup legacy|snapshot    Zeit bis zum ersten gültigen Bild nach dem Einschalten
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <LovyanGFX.hpp>
+#include <lvgl.h>
+#include "defines.h"
+#include "data.h"
+#include "i2c.h"
+#include "display.h"
+#include "format.h"
+#include "hostCapture.h"
+#include "hostLegacyDecode.h"
+#include "hostTrace.h"
+#include "trace.h"
+
+extern TwoWire I2C;
+void processRxData(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen);  //i2c.cpp
+
+#define HOST_MAX_FRAMES   256
+
+struct hostFrame_s
+{
+  uint8_t u8_len;
+  uint8_t u8_data[I2C_RX_FRAME_MAX];
+};
+
+static struct hostFrame_s frames[HOST_MAX_FRAMES];
+static uint16_t u16_mFrameCnt;
+static bool bo_mBatch;          //Sammelframes statt Einzelframes erzeugen
+static bool bo_mDelta;          //Zellspannungen als Delta senden
+static uint8_t u8_mCellFullReq; //Vom Display angeforderte vollständige Zellframes (Fähigkeiten-Antwort)
+static uint16_t u16_mSentCells[BMS_DEVICES_COUNT][BMS_CELLS_MAX];  //Basis, wie sie der BSC annimmt
+static bool bo_mCrc;            //Frames mit laufender Nummer und CRC sichern
+static uint8_t u8_mSeq;
+static uint32_t u32_mCorruptEvery;  //Jeden N-ten Frame verfälschen (0 = nie)
+static uint32_t u32_mInjected;
+
+
+//Datensatz an den letzten Sammelframe anhängen oder einen neuen beginnen
+static void addRecord(uint8_t u8_lGroup, uint8_t u8_lId, uint8_t u8_lBmsNr, const void *payload, uint8_t u8_lLen)
+{
+  struct hostFrame_s *f = (u16_mFrameCnt>0) ? &frames[u16_mFrameCnt-1] : NULL;
+  if(f==NULL || f->u8_data[0]!=BATCH_DATA || f->u8_data[1]!=u8_lGroup || f->u8_data[2]!=u8_lBmsNr ||
+    f->u8_len+BATCH_RECORD_HDR+u8_lLen>I2C_RX_FRAME_MAX-1)          //Platz für die CRC lassen
+  {
+    f=&frames[u16_mFrameCnt++];
+    f->u8_data[0]=BATCH_DATA;
+    f->u8_data[1]=u8_lGroup;
+    f->u8_data[2]=u8_lBmsNr;
+    f->u8_data[3]=0;
+    f->u8_len=RXBUFF_OFFSET;
+  }
+  f->u8_data[f->u8_len++]=u8_lId;
+  f->u8_data[f->u8_len++]=u8_lLen;
+  memcpy(&f->u8_data[f->u8_len], payload, u8_lLen);
+  f->u8_len+=u8_lLen;
+}
+
+
+static void addFrame(uint8_t u8_lGroup, uint8_t u8_lId, uint8_t u8_lBmsNr, const void *payload, uint8_t u8_lLen)
+{
+  if(bo_mBatch)
+  {
+    addRecord(u8_lGroup, u8_lId, u8_lBmsNr, payload, u8_lLen);
+    return;
+  }
+
+  struct hostFrame_s *f = &frames[u16_mFrameCnt++];
+  f->u8_data[0]=u8_lGroup;
+  f->u8_data[1]=u8_lId;
+  f->u8_data[2]=u8_lBmsNr;
+  f->u8_data[3]=0;
+  memcpy(&f->u8_data[RXBUFF_OFFSET], payload, u8_lLen);
+  f->u8_len=RXBUFF_OFFSET+u8_lLen;
+}
+
+
+//Zellspannungen wie der BSC senden: als Delta, wenn das Display eine Basis hat und alle Deltas in int8 passen
+static void addCells(uint8_t u8_lBmsNr, const uint16_t *cells)
+{
+  if(bo_mDelta && (u8_mCellFullReq&(1<<u8_lBmsNr))==0)
+  {
+    uint8_t u8_lBuf[CELL_DELTA_HDR+BMS_CELLS_MAX];
+    uint8_t u8_lLen=CELL_DELTA_HDR;
+    uint32_t u32_lMask=0;
+    bool bo_lFits=true;
+    for(uint8_t c=0;c<BMS_CELLS_MAX && bo_lFits;c++)
+    {
+      int32_t i32_lDelta=(int32_t)cells[c]-u16_mSentCells[u8_lBmsNr][c];
+      if(i32_lDelta==0) continue;
+      if(i32_lDelta<INT8_MIN || i32_lDelta>INT8_MAX) bo_lFits=false;
+      u32_lMask|=(1UL<<c);
+      u8_lBuf[u8_lLen++]=(uint8_t)(int8_t)i32_lDelta;
+    }
+
+    if(bo_lFits)
+    {
+      uint16_t u16_lCheck=i2cCellChecksum(u16_mSentCells[u8_lBmsNr]);
+      u8_lBuf[0]=u16_lCheck&0xFF;
+      u8_lBuf[1]=u16_lCheck>>8;
+      u8_lBuf[2]=u32_lMask&0xFF;
+      u8_lBuf[3]=(u32_lMask>>8)&0xFF;
+      u8_lBuf[4]=(u32_lMask>>16)&0xFF;
+      addFrame(BMS_DATA, BMS_CELL_VOLTAGE_DELTA, u8_lBmsNr, u8_lBuf, u8_lLen);
+      memcpy(u16_mSentCells[u8_lBmsNr], cells, sizeof(u16_mSentCells[0]));
+      return;
+    }
+  }
+
+  addFrame(BMS_DATA, BMS_CELL_VOLTAGE, u8_lBmsNr, cells, 48);
+  memcpy(u16_mSentCells[u8_lBmsNr], cells, sizeof(u16_mSentCells[0]));
+}
+
+
+//Einen vollständigen Zyklus wie vom BSC erzeugen; die Werte variieren leicht mit u32_lCycle
+static void buildCycle(uint32_t u32_lCycle)
+{
+  u16_mFrameCnt=0;
+
+  for(uint8_t n=0;n<BMS_DEVICES_COUNT;n++)
+  {
+    uint16_t u16_lCells[BMS_CELLS_MAX];
+    for(uint8_t c=0;c<BMS_CELLS_MAX;c++) u16_lCells[c]=3300+((c*7+n*3+u32_lCycle/(1+(c&3)))%20);
+    addCells(n, u16_lCells);
+
+    int16_t i16_lVal=5280+(u32_lCycle%10);
+    addFrame(BMS_DATA, BMS_TOTAL_VOLTAGE, n, &i16_lVal, 2);
+    uint16_t u16_lVal=20;
+    addFrame(BMS_DATA, BMS_MAX_CELL_DIFFERENCE_VOLTAGE, n, &u16_lVal, 2);
+    u16_lVal=3310;
+    addFrame(BMS_DATA, BMS_AVG_VOLTAGE, n, &u16_lVal, 2);
+    i16_lVal=-1200+(int16_t)((u32_lCycle*37+n)%300);
+    addFrame(BMS_DATA, BMS_TOTAL_CURRENT, n, &i16_lVal, 2);
+    u16_lVal=3319;
+    addFrame(BMS_DATA, BMS_MAX_CELL_VOLTAGE, n, &u16_lVal, 2);
+    u16_lVal=3300;
+    addFrame(BMS_DATA, BMS_MIN_CELL_VOLTAGE, n, &u16_lVal, 2);
+    uint8_t u8_lVal=3;
+    addFrame(BMS_DATA, BMS_MAX_VOLTAGE_CELL_NUMBER, n, &u8_lVal, 1);
+    addFrame(BMS_DATA, BMS_MIN_VOLTAGE_CELL_NUMBER, n, &u8_lVal, 1);
+    u8_lVal=(u32_lCycle/50)&1;
+    addFrame(BMS_DATA, BMS_IS_BALANCING_ACTIVE, n, &u8_lVal, 1);
+    i16_lVal=0;
+    addFrame(BMS_DATA, BMS_BALANCING_CURRENT, n, &i16_lVal, 2);
+    int16_t i16_lTemp[3]={2150,2210,2190};
+    addFrame(BMS_DATA, BMS_TEMPERATURE, n, i16_lTemp, 6);
+    u8_lVal=80;
+    addFrame(BMS_DATA, BMS_CHARGE_PERCENT, n, &u8_lVal, 1);
+    uint32_t u32_lErr=0;
+    addFrame(BMS_DATA, BMS_ERRORS, n, &u32_lErr, 4);
+  }
+
+  int16_t i16_lVal=5280;
+  addFrame(INVERTER_DATA, INVERTER_VOLTAGE, 0, &i16_lVal, 2);
+  i16_lVal=-120+(int16_t)(u32_lCycle%30);
+  addFrame(INVERTER_DATA, INVERTER_CURRENT, 0, &i16_lVal, 2);
+  uint16_t u16_lVal=80;
+  addFrame(INVERTER_DATA, INVERTER_SOC, 0, &u16_lVal, 2);
+  i16_lVal=100;
+  addFrame(INVERTER_DATA, INVERTER_CHARGE_CURRENT, 0, &i16_lVal, 2);
+  addFrame(INVERTER_DATA, INVERTER_DISCHARG_CURRENT, 0, &i16_lVal, 2);
+
+  u16_lVal=0;
+  addFrame(BSC_DATA, BSC_ALARMS, 0, &u16_lVal, 2);
+  uint8_t u8_lVal=0x05;
+  addFrame(BSC_DATA, BSC_RELAIS, 0, &u8_lVal, 1);
+  u8_lVal=5;
+  addFrame(BSC_DATA, BSC_DISPLAY_TIMEOUT, 0, &u8_lVal, 1);
+}
+
+
+static void injectCycle()
+{
+  for(uint16_t i=0;i<u16_mFrameCnt;i++)
+  {
+    if(!bo_mCrc)
+    {
+      I2C.inject(frames[i].u8_data, frames[i].u8_len);
+    }
+    else
+    {
+      uint8_t u8_lBuf[I2C_RX_FRAME_MAX];
+      uint8_t u8_lLen=frames[i].u8_len;
+      memcpy(u8_lBuf, frames[i].u8_data, u8_lLen);
+      u8_lBuf[3]=I2C_FRAME_SEQ_CRC|(u8_mSeq++&I2C_FRAME_SEQ_MASK);
+      u8_lBuf[u8_lLen]=i2cCrc8(u8_lBuf, u8_lLen);
+      u8_lLen++;
+      if(u32_mCorruptEvery>0 && (++u32_mInjected%u32_mCorruptEvery)==0) u8_lBuf[u8_lLen/2]^=0x10;   //Gestörte Übertragung
+      I2C.inject(u8_lBuf, u8_lLen);
+    }
+    i2cProcessRxFrames();
+  }
+}
+
+
+//Einen Zyklus als Snapshot (SNAPSHOT_DATA) in Teile zerlegt erzeugen
+static void buildSnapshot(uint32_t u32_lCycle)
+{
+  static uint8_t u8_lBlob[I2C_SNAPSHOT_MAX];
+  uint16_t u16_lLen=0;
+
+  buildCycle(u32_lCycle);
+  for(uint16_t i=0;i<u16_mFrameCnt;i++)
+  {
+    const struct hostFrame_s *f = &frames[i];
+    uint8_t u8_lValLen=f->u8_len-RXBUFF_OFFSET;
+    memcpy(&u8_lBlob[u16_lLen], f->u8_data, 3);                       //Gruppe, ID, BMS-Nr
+    u8_lBlob[u16_lLen+3]=u8_lValLen;
+    memcpy(&u8_lBlob[u16_lLen+SNAPSHOT_RECORD_HDR], &f->u8_data[RXBUFF_OFFSET], u8_lValLen);
+    u16_lLen+=SNAPSHOT_RECORD_HDR+u8_lValLen;
+  }
+
+  //Teil 0 trägt zusätzlich die Gesamtlänge; Platz für die CRC lassen
+  const uint8_t u8_lChunkMax=I2C_RX_FRAME_MAX-RXBUFF_OFFSET-1;
+  uint8_t u8_lChunkCnt=(u16_lLen+2+u8_lChunkMax-1)/u8_lChunkMax;
+  uint16_t u16_lPos=0;
+  u16_mFrameCnt=0;
+  for(uint8_t n=0;n<u8_lChunkCnt;n++)
+  {
+    struct hostFrame_s *f = &frames[u16_mFrameCnt++];
+    f->u8_data[0]=SNAPSHOT_DATA;
+    f->u8_data[1]=n;
+    f->u8_data[2]=u8_lChunkCnt;
+    f->u8_data[3]=0;
+    f->u8_len=RXBUFF_OFFSET;
+    if(n==0)
+    {
+      f->u8_data[f->u8_len++]=u16_lLen&0xFF;
+      f->u8_data[f->u8_len++]=u16_lLen>>8;
+    }
+    uint8_t u8_lPart=u8_lChunkMax-(f->u8_len-RXBUFF_OFFSET);
+    if(u8_lPart>u16_lLen-u16_lPos) u8_lPart=u16_lLen-u16_lPos;
+    memcpy(&f->u8_data[f->u8_len], &u8_lBlob[u16_lPos], u8_lPart);
+    f->u8_len+=u8_lPart;
+    u16_lPos+=u8_lPart;
+  }
+}
+
+
+//Statusregister wie der BSC lesen und ausgeben; liefert das Statusbyte
+static uint8_t readStatus(bool bo_lPrint)
+{
+  uint8_t u8_lReg[I2C_STATUS_LEN]={0};
+  size_t len=I2C.request(u8_lReg, sizeof(u8_lReg));
+  if(bo_lPrint)
+  {
+    Serial.printf("status:  %u bytes, proto %02X v%u, caps %02X, cell req %02X, status %02X, gen %u, dropped %u, overflow %u\n",
+      (unsigned)len, u8_lReg[0], u8_lReg[1], u8_lReg[2], u8_lReg[3], u8_lReg[4],
+      u8_lReg[5] | (u8_lReg[6]<<8) | (u8_lReg[7]<<16) | ((uint32_t)u8_lReg[8]<<24),
+      u8_lReg[9] | (u8_lReg[10]<<8), u8_lReg[11] | (u8_lReg[12]<<8));
+  }
+  return u8_lReg[4];
+}
+
+
+//Wie der Display-Task im Leerlauf die übrigen Tabs bauen; displayRunCyclic() baut höchstens einen je Aufruf
+static void buildAllTabs()
+{
+  struct displayStats_s dispStats;
+  for(uint8_t i=0;i<=TAB_COUNT;i++)
+  {
+    getDisplayStats(&dispStats);
+    if(dispStats.u32_bootMs[BOOT_ALL_TABS]!=0) return;
+    displayRunCyclic();
+  }
+}
+
+
+/*
+ * Zeit bis zum ersten gültigen Bild nach dem Einschalten; braucht einen frischen Prozess.
+ * legacy: das Display steigt mitten im Zyklus ein, gültig ist erst der nächste vollständige Zyklus.
+ * snapshot: der BSC liest das Statusregister und schickt den angeforderten Snapshot.
+ * Die Buszeit ist bei 1 MHz geschätzt (9 Bit je Byte inkl. Adresse, Start/Stop), ohne Pausen im BSC.
+ */
+static int benchStartup(const char *mode)
+{
+  bool bo_lSnapshot=(strcmp(mode, "snapshot")==0);
+  uint32_t u32_lFrames=0;
+  uint32_t u32_lBusBits=0;
+  uint32_t u32_lStart=micros();
+
+  if(bo_lSnapshot && (readStatus(true)&I2C_STATUS_SNAPSHOT)==0) return 1;
+
+  for(uint8_t u8_lPass=0;u8_lPass<(bo_lSnapshot ? 1 : 2);u8_lPass++)
+  {
+    if(bo_lSnapshot) buildSnapshot(0);
+    else buildCycle(u8_lPass);
+
+    for(uint16_t i=(bo_lSnapshot || u8_lPass>0) ? 0 : u16_mFrameCnt/2;i<u16_mFrameCnt;i++)
+    {
+      I2C.inject(frames[i].u8_data, frames[i].u8_len);
+      i2cProcessRxFrames();
+      displayNewBscData();
+      lv_refr_now(NULL);
+      u32_lFrames++;
+      u32_lBusBits+=(frames[i].u8_len+1)*9+2;
+    }
+  }
+  uint32_t u32_lCpuUs=micros()-u32_lStart;
+  buildAllTabs();
+
+  struct displayStats_s dispStats;
+  struct i2cStats_s i2cStats;
+  getDisplayStats(&dispStats);
+  getI2cStats(&i2cStats);
+  Serial.printf("startup: %s, %u transactions, %u bytes, bus ~%.2f ms, cpu %.2f ms, %u cycles drawn, %u snapshots\n", mode,
+    u32_lFrames, (u32_lBusBits/9), u32_lBusBits/1000.0, u32_lCpuUs/1000.0, dispStats.u32_cyclesDrawn, i2cStats.u32_snapshots);
+  Serial.printf("boot:    lcd %u, lvgl %u, home %u, first flush %u, first data %u, all tabs %u ms\n", dispStats.u32_bootMs[BOOT_LCD_INIT],
+    dispStats.u32_bootMs[BOOT_LVGL_INIT], dispStats.u32_bootMs[BOOT_HOME_BUILT], dispStats.u32_bootMs[BOOT_FIRST_FLUSH],
+    dispStats.u32_bootMs[BOOT_FIRST_DATA], dispStats.u32_bootMs[BOOT_ALL_TABS]);
+  readStatus(true);
+  return 0;
+}
+
+
+//Dekodierung im eingestellten Modus (bo_mBatch/bo_mDelta/bo_mCrc); Zeit, Transaktionen und Bytes je Zyklus
+static void benchDecode(const char *name, uint32_t u32_lCycles)
+{
+  uint32_t u32_lFrames=0;
+  uint32_t u32_lBytes=0;
+  uint32_t u32_lStart=micros();
+  for(uint32_t c=0;c<u32_lCycles;c++)
+  {
+    if(bo_mDelta)
+    {
+      //Wie der BSC vor jedem Zyklus lesen, für welche BMS ein vollständiger Zellframe nötig ist
+      uint8_t u8_lCaps[4]={0};
+      I2C.request(u8_lCaps, sizeof(u8_lCaps));
+      u8_mCellFullReq=u8_lCaps[3];
+    }
+    buildCycle(c);
+    injectCycle();
+    u32_lFrames+=u16_mFrameCnt;
+    for(uint16_t i=0;i<u16_mFrameCnt;i++) u32_lBytes+=frames[i].u8_len+(bo_mCrc ? 1 : 0);
+  }
+  uint32_t u32_lUs=micros()-u32_lStart;
+  if(u32_lCycles==0) u32_lCycles=1;
+
+  Serial.printf("%-8s %.2f us/cycle, %.1f transactions, %.0f bytes per cycle\n", name, (double)u32_lUs/u32_lCycles,
+    (double)u32_lFrames/u32_lCycles, (double)u32_lBytes/u32_lCycles);
+}
+
+
+//Nur den Dekoder messen (ohne Ringpuffer): Feldtabelle gegen den früheren switch-Dekoder,
+//beide über dieselben Einzelframes
+static void benchDecoder(uint32_t u32_lCycles)
+{
+  uint32_t u32_lFrames=0, u32_lTableUs=0, u32_lSwitchUs=0;
+  for(uint32_t c=0;c<u32_lCycles;c++)
+  {
+    buildCycle(c);
+    uint32_t u32_lStart=micros();
+    for(uint16_t i=0;i<u16_mFrameCnt;i++) processRxData(frames[i].u8_data, frames[i].u8_len);
+    u32_lTableUs+=micros()-u32_lStart;
+
+    u32_lStart=micros();
+    for(uint16_t i=0;i<u16_mFrameCnt;i++) legacyProcessRxData(frames[i].u8_data, frames[i].u8_len);
+    u32_lSwitchUs+=micros()-u32_lStart;
+    u32_lFrames+=u16_mFrameCnt;
+  }
+
+  //Beide Dekoder müssen dasselbe Ergebnis liefern
+  acquireData();
+  const struct data_s *lLegacy = legacyDecodeData();
+  bool bo_lSame = legacyDecodeCycles()==u32_lCycles &&
+    memcmp(lLegacy->bmsCellVoltage, getData()->bmsCellVoltage, sizeof(lLegacy->bmsCellVoltage))==0 &&
+    memcmp(lLegacy->bmsTotalVoltage, getData()->bmsTotalVoltage, sizeof(lLegacy->bmsTotalVoltage))==0;
+
+  Serial.printf("decoder: table %.0f frames/s, switch (baseline) %.0f frames/s, %u frames%s\n",
+    u32_lFrames*1e6/(u32_lTableUs ? u32_lTableUs : 1), u32_lFrames*1e6/(u32_lSwitchUs ? u32_lSwitchUs : 1), u32_lFrames,
+    bo_lSame ? "" : " (MISMATCH)");
+}
+
+
+static void benchFormat()
+{
+  const uint32_t u32_lLoops=1000000;
+  static char txt[32];
+  volatile uint32_t u32_lSink=0;
+
+  uint32_t u32_lStart=micros();
+  for(uint32_t i=0;i<u32_lLoops;i++)
+  {
+    snprintf(txt, sizeof(txt), "%.1f", (int16_t)(i&0x7FFF)/100.0);
+    u32_lSink+=txt[0];
+  }
+  uint32_t u32_lPrintf=micros()-u32_lStart;
+
+  u32_lStart=micros();
+  for(uint32_t i=0;i<u32_lLoops;i++)
+  {
+    fmtFixed(txt, (int16_t)(i&0x7FFF), 2, 1);
+    u32_lSink+=txt[0];
+  }
+  uint32_t u32_lFmt=micros()-u32_lStart;
+
+  Serial.printf("format:  snprintf %%.1f %.1f ns/value, fmtFixed %.1f ns/value\n",
+    u32_lPrintf*1000.0/u32_lLoops, u32_lFmt*1000.0/u32_lLoops);
+}
+
+
+//Vollbild 480x320 RGB565 einmal mit Bytetausch je Pixel, einmal als reine Kopie
+static void benchFlushCopy()
+{
+  const uint32_t u32_lPx=HOSTSIM_LCD_WIDTH*HOSTSIM_LCD_HEIGHT;
+  const uint32_t u32_lLoops=200;
+  uint16_t *src=(uint16_t *)malloc(u32_lPx*2);
+  uint16_t *dst=(uint16_t *)malloc(u32_lPx*2);
+  for(uint32_t i=0;i<u32_lPx;i++) src[i]=(uint16_t)(i*2654435761UL);
+
+  uint32_t u32_lStart=micros();
+  for(uint32_t l=0;l<u32_lLoops;l++)
+  {
+    for(uint32_t i=0;i<u32_lPx;i++) dst[i]=(uint16_t)((src[i]<<8)|(src[i]>>8));
+    __asm__ volatile("" : : "r"(dst) : "memory");
+  }
+  uint32_t u32_lSwap=micros()-u32_lStart;
+
+  u32_lStart=micros();
+  for(uint32_t l=0;l<u32_lLoops;l++)
+  {
+    memcpy(dst, src, u32_lPx*2);
+    __asm__ volatile("" : : "r"(dst) : "memory");
+  }
+  uint32_t u32_lCopy=micros()-u32_lStart;
+
+  Serial.printf("flush:   480x320 swap %.1f us/frame, copy %.1f us/frame\n",
+    (double)u32_lSwap/u32_lLoops, (double)u32_lCopy/u32_lLoops);
+
+  free(src);
+  free(dst);
+}
+
+
+//Synthetische Zyklen im Abstand von 1 s, Frames im Abstand von 200 us
+static int recordCapture(const char *fileName, uint32_t u32_lCycles)
+{
+  FILE *f=fopen(fileName, "wb");
+  if(f==NULL)
+  {
+    Serial.printf("record: cannot open %s\n", fileName);
+    return 1;
+  }
+
+  for(uint32_t c=0;c<u32_lCycles;c++)
+  {
+    buildCycle(c);
+    for(uint16_t i=0;i<u16_mFrameCnt;i++) captureWrite(f, c*1000000UL+i*200UL, frames[i].u8_data, frames[i].u8_len);
+  }
+  fclose(f);
+  Serial.printf("record:  %u cycles written to %s\n", u32_lCycles, fileName);
+  return 0;
+}
+
+
+#ifndef HOSTSIM_FUZZ
+int main(int argc, char **argv)
+{
+  if(argc>2 && strcmp(argv[1], "record")==0)
+  {
+    return recordCapture(argv[2], (argc>3) ? strtoul(argv[3], NULL, 0) : 100);
+  }
+
+  if(argc>3 && strcmp(argv[1], "trace")==0)
+  {
+    return traceConvert(argv[2], argv[3]);
+  }
+
+  displayInit();
+  initI2C();
+
+  #ifdef TRACE_ENABLE
+  if(argc>1 && strcmp(argv[1], "tracedump")==0)
+  {
+    //Einige Zyklen dekodieren und zeichnen, dann den Ring wie auf dem Gerät ausgeben
+    uint32_t u32_lCycles = (argc>2) ? strtoul(argv[2], NULL, 0) : 10;
+    for(uint32_t c=0;c<u32_lCycles;c++)
+    {
+      buildCycle(c);
+      injectCycle();
+      displayNewBscData();
+      displayRunCyclic();
+      lv_refr_now(NULL);   //Refresh-Timer ist auf dem Host evtl. noch nicht fällig
+    }
+    traceDump();
+    return 0;
+  }
+  #endif
+
+  if(argc>2 && strcmp(argv[1], "replay")==0)
+  {
+    return replayCapture(argv[2], (argc>3) ? strtoul(argv[3], NULL, 0) : 1);
+  }
+
+  if(argc>2 && strcmp(argv[1], "startup")==0)
+  {
+    return benchStartup(argv[2]);
+  }
+
+  uint32_t u32_lCycles = (argc>1) ? strtoul(argv[1], NULL, 0) : 1000;
+
+  //Dekodierung
+  uint32_t u32_lFrames=0;
+  uint32_t u32_lStart=micros();
+  for(uint32_t c=0;c<u32_lCycles;c++)
+  {
+    buildCycle(c);
+    injectCycle();
+    u32_lFrames+=u16_mFrameCnt;
+  }
+  uint32_t u32_lDecodeUs=micros()-u32_lStart;
+
+  Serial.printf("decode:  %u frames in %u us, %.0f frames/s, %.2f us/cycle\n", u32_lFrames, u32_lDecodeUs,
+    u32_lFrames*1e6/(u32_lDecodeUs ? u32_lDecodeUs : 1), (double)u32_lDecodeUs/(u32_lCycles ? u32_lCycles : 1));
+  benchDecoder(u32_lCycles);
+
+  //Protokollerweiterungen nacheinander zuschalten; wie der BSC vorher die Fähigkeiten abfragen
+  uint8_t u8_lCaps[4]={0};
+  I2C.request(u8_lCaps, sizeof(u8_lCaps));
+  if(u8_lCaps[0]==I2C_PROTO_ID)
+  {
+    benchDecode("legacy:", u32_lCycles);
+    bo_mBatch=(u8_lCaps[2]&I2C_CAP_BATCH);
+    if(bo_mBatch) benchDecode("batch:", u32_lCycles);
+    bo_mDelta=bo_mBatch && (u8_lCaps[2]&I2C_CAP_CELL_DELTA);
+    if(bo_mDelta) benchDecode("delta:", u32_lCycles);
+    bo_mCrc=bo_mDelta && (u8_lCaps[2]&I2C_CAP_CRC);
+    if(bo_mCrc)
+    {
+      benchDecode("crc:", u32_lCycles);
+      u32_mCorruptEvery=64;
+      benchDecode("corrupt:", u32_lCycles);
+      u32_mCorruptEvery=0;
+
+      //Einen sauberen Zyklus hinterher, damit der Dekoder wieder synchron ist
+      benchDecode("resync:", 1);
+    }
+    bo_mBatch=false;
+    bo_mDelta=false;
+    bo_mCrc=false;
+  }
+
+  //CRC-Durchsatz
+  uint32_t u32_lCrcSink=0;
+  u32_lStart=micros();
+  for(uint32_t i=0;i<100000;i++) u32_lCrcSink+=i2cCrc8(frames[i%u16_mFrameCnt].u8_data, I2C_RX_FRAME_MAX);
+  uint32_t u32_lCrcUs=micros()-u32_lStart;
+  Serial.printf("crc8:    %.2f ns/byte (%u)\n", u32_lCrcUs*1000.0/(100000.0*I2C_RX_FRAME_MAX), u32_lCrcSink&0xFF);
+
+  //Dekodierung und Anzeige
+  uint64_t u64_lPxStart=LGFX::pixelsPushed();
+  uint32_t u32_lRenderUs=0;
+  for(uint32_t c=0;c<u32_lCycles;c++)
+  {
+    buildCycle(c);
+    injectCycle();
+
+    uint32_t u32_lT=micros();
+    displayNewBscData();
+    lv_refr_now(NULL);
+    u32_lRenderUs+=micros()-u32_lT;
+    displayRunCyclic();   //Leerlauf: Timer, übrige Tabs bauen
+  }
+  buildAllTabs();         //Bei wenigen Zyklen fehlen sonst Tabs im Heap-Bericht
+
+  struct i2cStats_s i2cStats;
+  struct displayStats_s dispStats;
+  getI2cStats(&i2cStats);
+  getDisplayStats(&dispStats);
+
+  Serial.printf("render:  %u cycles in %u us, %.1f cycles/s, %.1f us/cycle, %llu px pushed\n", u32_lCycles, u32_lRenderUs,
+    u32_lCycles*1e6/(u32_lRenderUs ? u32_lRenderUs : 1), (double)u32_lRenderUs/(u32_lCycles ? u32_lCycles : 1),
+    (unsigned long long)(LGFX::pixelsPushed()-u64_lPxStart));
+  Serial.printf("stats:   rx %u, ring overflow %u, drawn %u, skipped %u\n", i2cStats.u32_rxFrames, i2cStats.u32_ringOverflow,
+    dispStats.u32_cyclesDrawn, dispStats.u32_cyclesSkipped);
+  Serial.printf("drops:   oversize %u, short %u, unknown %u, bmsNr %u, payload %u\n", i2cStats.u32_dropOversize,
+    i2cStats.u32_dropShort, i2cStats.u32_dropUnknown, i2cStats.u32_dropBmsNr, i2cStats.u32_dropPayload);
+  uint32_t u32_lCl=i2cStats.u32_cyclesLegacy ? i2cStats.u32_cyclesLegacy : 1;
+  uint32_t u32_lCb=i2cStats.u32_cyclesBatch ? i2cStats.u32_cyclesBatch : 1;
+  Serial.printf("wire:    legacy %.1f transactions, %.0f bytes per cycle; batch %.1f transactions, %.0f bytes per cycle\n",
+    (double)i2cStats.u32_framesLegacy/u32_lCl, (double)i2cStats.u32_bytesLegacy/u32_lCl,
+    (double)i2cStats.u32_framesBatch/u32_lCb, (double)i2cStats.u32_bytesBatch/u32_lCb);
+  Serial.printf("frames:  %u cell deltas, %u delta mismatch, %u crc errors, %u seq gaps, %u suspect cycles (%u not drawn)\n",
+    i2cStats.u32_cellDeltas, i2cStats.u32_cellDeltaMismatch, i2cStats.u32_crcErrors, i2cStats.u32_seqGaps,
+    i2cStats.u32_cyclesSuspect, dispStats.u32_cyclesSuspect);
+  latHistPrint("latency: callback->task", &i2cStats.rxWake);
+
+  struct displayMemStats_s memStats;
+  getDisplayMemStats(&memStats);
+  Serial.printf("lvmem:   %u/%u B used (%u B internal), peak %u B, biggest free %u B, frag %u %%, base %u B\n",
+    memStats.u32_heapUsed, memStats.u32_heapSize, memStats.u32_heapInternal, memStats.u32_heapPeak, memStats.u32_heapBiggest, memStats.u8_heapFrag, memStats.u32_baseBytes);
+  for(uint8_t t=0;t<TAB_COUNT;t++)
+  {
+    Serial.printf("         tab %u: %u B in %u blocks\n", t, memStats.u32_tabBytes[t], memStats.u16_tabAllocs[t]);
+  }
+
+  readStatus(true);
+
+  benchFormat();
+  benchFlushCopy();
+
+  return 0;
+}
+#endif
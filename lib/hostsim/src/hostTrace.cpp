@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "hostTrace.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_CORES   2
+
+
+int traceConvert(const char *dumpFile, const char *jsonFile)
+{
+  FILE *in=fopen(dumpFile, "r");
+  if(in==NULL)
+  {
+    printf("trace: cannot open %s\n", dumpFile);
+    return 1;
+  }
+  FILE *out=fopen(jsonFile, "w");
+  if(out==NULL)
+  {
+    printf("trace: cannot create %s\n", jsonFile);
+    fclose(in);
+    return 1;
+  }
+
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"bsc_display\"}}");
+  for(uint8_t c=0;c<TRACE_CORES;c++)
+  {
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"core %u\"}}", c, c);
+  }
+
+  char line[128];
+  char name[32];
+  char type;
+  unsigned int u32_lUs, u32_lCore;
+  uint32_t u32_lPrevUs=0;
+  uint64_t u64_lWrap=0;
+  uint32_t u32_lDepth[TRACE_CORES]={0};
+  uint32_t u32_lEvents=0, u32_lSkipped=0;
+
+  while(fgets(line, sizeof(line), in)!=NULL)
+  {
+    if(strncmp(line, "#TRACE ", 7)==0)
+    {
+      //Neuer Dump: offene Begin-Ereignisse des vorherigen enden hier
+      memset(u32_lDepth, 0, sizeof(u32_lDepth));
+      continue;
+    }
+    if(sscanf(line, "#T %u %u %c %31s", &u32_lUs, &u32_lCore, &type, name)!=4 || u32_lCore>=TRACE_CORES)
+    {
+      continue;
+    }
+
+    //micros() läuft nach ~71 min über; die Ereignisse kommen zeitlich sortiert (bis auf wenige us zwischen den Kernen)
+    if(u32_lEvents>0 && u32_lUs<u32_lPrevUs && u32_lPrevUs-u32_lUs>0x80000000UL) u64_lWrap+=0x100000000ULL;
+    u32_lPrevUs=u32_lUs;
+    uint64_t u64_lTs=u64_lWrap+u32_lUs;
+
+    const char *ph;
+    if(type=='B')
+    {
+      ph="B";
+      u32_lDepth[u32_lCore]++;
+    }
+    else if(type=='E')
+    {
+      //Das zugehörige Begin wurde im Ring bereits überschrieben
+      if(u32_lDepth[u32_lCore]==0)
+      {
+        u32_lSkipped++;
+        continue;
+      }
+      ph="E";
+      u32_lDepth[u32_lCore]--;
+    }
+    else ph="i";
+
+    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%llu,\"pid\":0,\"tid\":%u%s}", name, ph,
+      (unsigned long long)u64_lTs, u32_lCore, (type=='I') ? ",\"s\":\"t\"" : "");
+    u32_lEvents++;
+  }
+  fprintf(out, "\n]}\n");
+
+  fclose(in);
+  fclose(out);
+  printf("trace: %u events, %u unmatched end events skipped -> %s\n", u32_lEvents, u32_lSkipped, jsonFile);
+  return 0;
+}
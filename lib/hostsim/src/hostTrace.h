@@ -0,0 +1,14 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef HOSTSIM_HOSTTRACE_H
+#define HOSTSIM_HOSTTRACE_H
+
+//Trace-Dump des Displays (Format siehe trace.h, TRACE_ENABLE) in das Chrome-/Perfetto-JSON-Format wandeln.
+//Zeilen ohne "#T " (sonstige Serial-Ausgaben) werden übersprungen.
+int traceConvert(const char *dumpFile, const char *jsonFile);
+
+
+#endif
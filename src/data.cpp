@@ -4,12 +4,94 @@
 // https://opensource.org/licenses/MIT
 
 
+#include <atomic>
 #include "data.h"
 
 
-static struct data_s data;
+#define DATA_BUF_IDX_MASK   0x03
+#define DATA_BUF_NEW        0x80  //Puffer wurde veröffentlicht, aber noch nicht von der Anzeige übernommen
+
+/*
+ * Triple-Buffer zwischen I2C-Task (Schreiber) und Display-Task (Leser).
+ * Der Empfang schreibt nur in dataStaging. Am Zyklusende wird dieser in den
+ * Back-Puffer kopiert und per atomarem Tausch mit dem Middle-Puffer veröffentlicht.
+ * Die Anzeige tauscht Middle und Front und liest danach nur aus dem Front-Puffer,
+ * den der Schreiber nie anfasst. Dadurch gibt es keine halb aktualisierten Werte
+ * und der Leser muss weder sperren noch kopieren.
+ */
+static struct data_s dataStaging;
+static struct data_s dataBuf[3];
+
+static uint8_t u8_mBackIdx=1;                   //Nur I2C-Task
+static uint8_t u8_mFrontIdx=0;                  //Nur Display-Task
+static std::atomic<uint8_t> u8_mMiddleIdx(2);
+
+/*
+ * Generationszähler: wird bei jedem veröffentlichten Zyklus um 1 erhöht.
+ * u32_mBufGen[] hält die Generation des jeweiligen Puffers und wird vom Schreiber
+ * vor dem Tausch gesetzt, ist also nach acquireData() für den Front-Puffer gültig.
+ */
+static uint32_t u32_mBufGen[3] = {0,0,0};
+static std::atomic<uint32_t> u32_mPublishedGen(0);
+static std::atomic<uint32_t> u32_mDisplayedGen(0);   //Schreibt nur die Anzeige, gelesen im I2C-Statusregister
+
 
 struct data_s * getData()
 {
-  return &data;
+  return &dataBuf[u8_mFrontIdx];
+}
+
+
+bool acquireData()
+{
+  if((u8_mMiddleIdx.load(std::memory_order_relaxed) & DATA_BUF_NEW) == 0) return false;
+
+  uint8_t u8_lOldMiddle = u8_mMiddleIdx.exchange(u8_mFrontIdx, std::memory_order_acq_rel);
+  u8_mFrontIdx = u8_lOldMiddle & DATA_BUF_IDX_MASK;
+  return true;
+}
+
+
+uint32_t getDataGeneration()
+{
+  return u32_mBufGen[u8_mFrontIdx];
+}
+
+
+uint32_t getPublishedGeneration()
+{
+  return u32_mPublishedGen.load(std::memory_order_relaxed);
+}
+
+
+void setDisplayedGeneration(uint32_t u32_lGen)
+{
+  u32_mDisplayedGen.store(u32_lGen, std::memory_order_relaxed);
+}
+
+
+uint32_t getDisplayedGeneration()
+{
+  return u32_mDisplayedGen.load(std::memory_order_relaxed);
+}
+
+
+struct data_s * getStagingData()
+{
+  return &dataStaging;
+}
+
+
+void publishData()
+{
+  memcpy(&dataBuf[u8_mBackIdx], &dataStaging, sizeof(struct data_s));
+  memset(&dataStaging.dirty, 0, sizeof(struct dataDirty_s));   //Nächster Zyklus sammelt neu
+
+  uint32_t u32_lGen = u32_mPublishedGen.load(std::memory_order_relaxed)+1;
+  u32_mBufGen[u8_mBackIdx] = u32_lGen;
+
+  uint8_t u8_lOldMiddle = u8_mMiddleIdx.exchange(u8_mBackIdx | DATA_BUF_NEW, std::memory_order_acq_rel);
+  u8_mBackIdx = u8_lOldMiddle & DATA_BUF_IDX_MASK;
+
+  u32_mPublishedGen.store(u32_lGen, std::memory_order_release);
 }
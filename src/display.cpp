@@ -6,6 +6,8 @@
 #include "display.h"
 #include "i2c.h"
 #include "data.h"
+#include "format.h"
+#include "trace.h"
 
 
 #define LGFX_AUTODETECT // Autodetect board
@@ -14,6 +16,7 @@
 #include <LovyanGFX.hpp> // main library
 #include <lvgl.h>
 #include "lv_conf.h"
+#include "lvmem.h"
 
 // Variables for touch x,y
 #ifdef DRAW_ON_SCREEN
@@ -25,12 +28,63 @@ static LGFX lcd;
 static const uint16_t screenWidth = 480;
 static const uint16_t screenHeight = 320;
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[screenWidth * 10];
+static lv_color_t *buf1;
+static lv_color_t *buf2;
+static bool bo_mFlushDma = false;    //false: nur ein Puffer, synchroner Flush
+
+//Mit LV_COLOR_16_SWAP liegen die Pixel bereits in Panel-Bytereihenfolge vor; der Flush ist dann eine reine Kopie
+#if LV_COLOR_16_SWAP
+#define DISP_PIXEL_SWAP   false
+typedef lgfx::swap565_t dispPixel_t;
+#else
+#define DISP_PIXEL_SWAP   true
+typedef lgfx::rgb565_t dispPixel_t;
+#endif
+
+static uint32_t u32_mPxPushed = 0;
+static uint32_t u32_mPxSkipped = 0;
+static uint32_t u32_mRefreshes = 0;       //Abgeschlossene Refreshes (letzter Flush eines Refresh)
+static uint32_t u32_mFlushUs = 0;         //Zeit im Flush-Callback
+static uint32_t u32_mLvglUs = 0;          //Zeit in lv_timer_handler() (Rendern und Flush)
+
+#ifdef DISP_TILE_DIFF
+#define DISP_TILES_X  ((screenWidth+DISP_TILE_W-1)/DISP_TILE_W)
+#define DISP_TILES_Y  ((screenHeight+DISP_TILE_H-1)/DISP_TILE_H)
+
+//Ein Streifen des Zeichenpuffers darf keine Kachelzeile zerschneiden, sonst passt die Prüfsumme
+//der Teilzeile nie zur gespeicherten und sie wird bei jedem Refresh übertragen
+static_assert(DISP_BUF_LINES%DISP_TILE_H==0, "DISP_BUF_LINES muss ein Vielfaches von DISP_TILE_H sein");
+
+//Prüfsumme des zuletzt übertragenen Kachelausschnitts; gilt nur für genau diesen Ausschnitt
+struct dispTile_s
+{
+  uint32_t u32_hash;
+  uint16_t u16_x1, u16_y1, u16_x2, u16_y2;
+};
+static struct dispTile_s dispTiles[DISP_TILES_Y][DISP_TILES_X];
+#endif
+
+#ifdef DISP_MEASURE_FLUSH
+//Zeiten des laufenden Refresh in us
+static uint32_t u32_mDmaStart;       //Start des letzten DMA-Transfers
+static uint32_t u32_mBusUs;          //Busaktivität (obere Schranke, Ende wird beim nächsten Flush erkannt)
+static uint32_t u32_mBlockedUs;      //Zeit, die der Flush-Callback die CPU blockiert hat
+static uint32_t u32_mOverlapUs;      //Busaktivität parallel zum Rendern
+#endif
 
 //Settings
 uint8_t u8_mPowersaveTime = 5;
 static struct data_s *lDataDisp;
 
+static uint32_t u32_mDisplayedGen = 0;    //Generation der zuletzt gezeichneten Daten
+static uint32_t u32_mDueUs = 0;           //Spätester nächster Aufruf von displayRunCyclic() (0 = unbekannt)
+static struct latHist_s loopLate;
+static struct latHist_s lvglRun;
+static uint32_t u32_mCyclesDrawn = 0;     //Gezeichnete Zyklen
+static uint32_t u32_mCyclesSkipped = 0;   //Zyklen, die zusammengefasst und nie gezeichnet wurden
+static uint32_t u32_mCyclesSuspect = 0;   //Zyklen mit CRC-Fehlern oder Lücken, nicht gezeichnet
+static uint8_t  u8_mSuspectRun = 0;       //Davon in Folge
+
 lv_obj_t * tabHome;
 lv_obj_t * tabZellSpg;
 lv_obj_t * tabSerBmsOverview;
@@ -44,23 +98,125 @@ lv_obj_t * kachelInverter2;
 
 lv_obj_t * relaisState[6];
 
+//Tab Zellspannungen: ein Objekt zeichnet alle Zellen selbst (statt BMS_DEVICES_COUNT*DISP_CELL_COUNT Labels
+//im LVGL-Heap); geänderte Zellen werden einzeln invalidiert, damit nur sie neu gezeichnet werden
+static lv_obj_t * cellGrid;
+static char cellTxt[BMS_DEVICES_COUNT][DISP_CELL_COUNT][6];
+static bool bo_mCellColVisible[BMS_DEVICES_COUNT];
+
+lv_obj_t * tabview;
+
+//Spaltenlayout der BMS-Tabs; Positionen werden aus der Topologie in defines.h berechnet
+#define COL_W                 44    //Spaltenbreite je BMS
+#define OVERVIEW_X0           70    //BMS-Übersichten: erste Spalte, links davon die Beschriftung
+#define OVERVIEW_LABEL_W      66    //BMS-Übersichten: Breite der Beschriftung
+#define ZELL_X0               33    //Zellspannungen: erste Spalte, links davon die Zellnummern
+#define ZELL_SER_GAP           8    //Zellspannungen: Abstand zwischen Bluetooth- und Serial-BMS
+#define ROW_H                 16    //Zeilenhöhe (LV_FONT_DEFAULT) der BMS-Tabs
+#define OVERVIEW_ROWS         16    //BMS-Übersichten: Kopfzeile, Leerzeile und 14 Wertzeilen
+
+static_assert(DISP_CELL_COUNT>=1 && DISP_CELL_COUNT<=BMS_CELLS_MAX, "DISP_CELL_COUNT: 1..BMS_CELLS_MAX");
+
+static constexpr lv_coord_t overviewColX(uint8_t u8_lCol, bool bo_lSerial) { return COL_W*u8_lCol+OVERVIEW_X0+(bo_lSerial ? 2 : 0); }
+static constexpr lv_coord_t overviewLineEnd(uint8_t u8_lCols) { return COL_W*u8_lCols+OVERVIEW_LABEL_W; }
+static constexpr lv_coord_t overviewHeight() { return ROW_H*OVERVIEW_ROWS-3; }
+static constexpr lv_coord_t zellColX(uint8_t u8_lBms) { return COL_W*u8_lBms+ZELL_X0+((u8_lBms>=BT_DEVICES_COUNT) ? ZELL_SER_GAP : 0); }
+static constexpr lv_coord_t zellRowY(uint8_t u8_lCell) { return ROW_H*(u8_lCell+2); }          //Kopfzeile + Leerzeile
+static constexpr lv_coord_t zellHeight() { return ROW_H*(DISP_CELL_COUNT+2)-3; }
+
+//Arbeitspuffer für Labeltexte; lv_label_set_text() kopiert den Text
+static char txtBuf[160];
+
+//Styles, in createScreens() initialisiert
+static lv_style_t style_line;
+static lv_style_t style_line2;
+static lv_style_t style_font1;
+static lv_style_t style_kachel;
+static lv_style_t style_fontKachel;
+
+//LVGL-Heap: Belegung beim Aufbau der Tabs
+static lv_mem_monitor_t memMark;         //Stand beim letzten memTabDone()
+static uint32_t u32_mBaseBytes = 0;
+static uint32_t u32_mTabBytes[TAB_COUNT];
+static uint16_t u16_mTabAllocs[TAB_COUNT];
+
+//Diagnosefeld im Tab Info; wird nur alle DISP_DIAG_PERIOD_MS und nur bei sichtbarem Tab aktualisiert
+static lv_obj_t *diagPanel;
+static lv_obj_t *diagLabel;
+static lv_timer_t *diagTimer;
+static char diagBuf[320];
+static uint32_t u32_mDiagMs;             //Zeitpunkt der Werte in diagI2c/diagDisp
+static uint32_t u32_mDiagGen;
+static struct i2cStats_s diagI2c;
+static struct displayStats_s diagDisp;
+
+//Noch nicht gezeichnete Änderungen je Tab; versteckte Tabs werden erst beim Umschalten nachgezogen
+static struct dataDirty_s tabDirty[TAB_COUNT];
+
+//Tabs werden erst beim ersten Anzeigen oder nach dem ersten Bild im Leerlauf aufgebaut
+static bool bo_mTabBuilt[TAB_COUNT];
+
+//Zeitpunkte beim Start in ms (0 = noch nicht erreicht)
+static uint32_t u32_mBootMs[BOOT_PHASE_COUNT];
+static const char *const bootPhaseNames[BOOT_PHASE_COUNT] = {"lcd init", "lvgl init", "home built", "first flush", "first data", "all tabs"};
+
 // Function declaration
 void display_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
+#ifdef DISP_MEASURE_FLUSH
+void display_monitor(lv_disp_drv_t *disp, uint32_t time, uint32_t px);
+#endif
+#ifdef DISP_TILE_DIFF
+static void display_rounder(lv_disp_drv_t *disp, lv_area_t *area);
+#endif
 void touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data);
 
 void createScreens(void);
+static void bootPhase(uint8_t u8_lPhase);
+static void buildTab(uint8_t u8_lTab);
+static bool buildIdleTab();
+static void buildTabHome();
+static void buildTabSerBms();
+static void buildTabBtBms();
+static void buildTabZellSpg();
+static void buildTabInfo();
+static void renderTab(uint16_t u16_lTab);
+static void diagSwitchEvent(lv_event_t *e);
+static void diagTimerCb(lv_timer_t *timer);
+static void renderTabHome(struct dataDirty_s *lDirty);
+static void renderTabBmsOverview(struct dataDirty_s *lDirty, lv_obj_t *tab, uint8_t u8_lFirst, uint8_t u8_lLast, const char *devType);
+static void renderTabZellSpg(struct dataDirty_s *lDirty);
+static void cellGridDraw(lv_event_t *e);
 
 
 void displayInit()
 {
   lcd.init(); // init LovyanGFX
+  bootPhase(BOOT_LCD_INIT);
+
   lv_init();  // init lvgl
+  bootPhase(BOOT_LVGL_INIT);
 
   // Setting display to landscape
   if (lcd.width() < lcd.height()) lcd.setRotation(lcd.getRotation() ^ 1);
 
   // LVGL; Setting up buffer to use for display
-  lv_disp_draw_buf_init(&draw_buf, buf, NULL, screenWidth * 10);
+  // Zwei Puffer im DMA-fähigen internen RAM: LVGL rendert in den einen, während der andere übertragen wird.
+  // PSRAM ist auf dem ESP32 nicht DMA-fähig und bleibt deshalb außen vor.
+  buf1 = (lv_color_t *)heap_caps_malloc(screenWidth * DISP_BUF_LINES * sizeof(lv_color_t), MALLOC_CAP_DMA);
+  buf2 = (lv_color_t *)heap_caps_malloc(screenWidth * DISP_BUF_LINES * sizeof(lv_color_t), MALLOC_CAP_DMA);
+  if(buf1!=NULL && buf2!=NULL)
+  {
+    bo_mFlushDma=true;
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, screenWidth * DISP_BUF_LINES);
+  }
+  else
+  {
+    //Fallback: nur ein Puffer, synchroner Flush
+    if(buf1==NULL) buf1=buf2;
+    buf2=NULL;
+    lv_disp_draw_buf_init(&draw_buf, buf1, NULL, screenWidth * DISP_BUF_LINES);
+    Serial.println("Display: DMA buffer alloc failed, sync flush");
+  }
 
   // LVGL; Setup + init display device driver
   static lv_disp_drv_t disp_drv;
@@ -69,6 +225,12 @@ void displayInit()
   disp_drv.ver_res = screenHeight;
   disp_drv.flush_cb = display_flush;
   disp_drv.draw_buf = &draw_buf;
+  #ifdef DISP_MEASURE_FLUSH
+  disp_drv.monitor_cb = display_monitor;
+  #endif
+  #ifdef DISP_TILE_DIFF
+  disp_drv.rounder_cb = display_rounder;
+  #endif
   lv_disp_drv_register(&disp_drv);
 
   // LVGL; Setup + init input device driver
@@ -78,44 +240,395 @@ void displayInit()
   indev_drv.read_cb = touchpad_read;
   lv_indev_drv_register(&indev_drv);
 
-
-  lDataDisp=getData();
+  //Nur Tabview und Home; die übrigen Tabs folgen nach dem ersten Bild
   createScreens();
+  buildTab(TAB_HOME);
+  bootPhase(BOOT_HOME_BUILT);
+}
+
+
+//Zeitpunkt einer Startphase einmalig festhalten und ausgeben
+static void bootPhase(uint8_t u8_lPhase)
+{
+  if(u32_mBootMs[u8_lPhase]!=0) return;
+  u32_mBootMs[u8_lPhase]=millis();
+  if(u32_mBootMs[u8_lPhase]==0) u32_mBootMs[u8_lPhase]=1;
+  Serial.printf("boot: %s %u ms\n", bootPhaseNames[u8_lPhase], u32_mBootMs[u8_lPhase]);
+}
+
+
+//LVGL-Heap abfragen. Mit LV_MEM_CUSTOM (lvmem.cpp) gibt es keinen festen Pool; als Größe gilt dann das,
+//was LVGL belegt, plus der noch freie PSRAM (ohne PSRAM der freie interne RAM).
+static void memMonitor(lv_mem_monitor_t *mon)
+{
+  #if LV_MEM_CUSTOM
+  struct lvMemStats_s lvStats;
+  getLvMemStats(&lvStats);
+  uint32_t u32_lCaps = (heap_caps_get_total_size(MALLOC_CAP_SPIRAM)>0) ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+  uint32_t u32_lUsed = lvStats.u32_psramBytes+lvStats.u32_internalBytes;
+  memset(mon, 0, sizeof(lv_mem_monitor_t));
+  mon->free_size=heap_caps_get_free_size(u32_lCaps);
+  mon->total_size=mon->free_size+u32_lUsed;
+  mon->free_biggest_size=heap_caps_get_largest_free_block(u32_lCaps);
+  mon->used_cnt=lvStats.u32_blocks;
+  mon->max_used=lvStats.u32_peakBytes;
+  mon->used_pct=(mon->total_size>0) ? (uint64_t)u32_lUsed*100/mon->total_size : 0;
+  mon->frag_pct=(mon->free_size>0) ? 100-(uint64_t)mon->free_biggest_size*100/mon->free_size : 0;
+  #else
+  lv_mem_monitor(mon);
+  #endif
+}
+
+
+//Belegung seit dem letzten Aufruf dem Tab zuordnen (TAB_COUNT: Tabview und Styles)
+static void memTabDone(uint8_t u8_lTab)
+{
+  lv_mem_monitor_t mon;
+  memMonitor(&mon);
+  uint32_t u32_lUsed = mon.total_size-mon.free_size;
+  uint32_t u32_lMarkUsed = memMark.total_size-memMark.free_size;
+  uint32_t u32_lBytes = (u32_lUsed>u32_lMarkUsed) ? u32_lUsed-u32_lMarkUsed : 0;
+
+  if(u8_lTab<TAB_COUNT)
+  {
+    u32_mTabBytes[u8_lTab]+=u32_lBytes;
+    u16_mTabAllocs[u8_lTab]+=(mon.used_cnt>memMark.used_cnt) ? mon.used_cnt-memMark.used_cnt : 0;
+  }
+  else u32_mBaseBytes+=u32_lBytes;
+
+  memMark=mon;
+}
+
+
+void getDisplayMemStats(struct displayMemStats_s *stats)
+{
+  lv_mem_monitor_t mon;
+  memMonitor(&mon);
+  stats->u32_heapSize=mon.total_size;
+  stats->u32_heapUsed=mon.total_size-mon.free_size;
+  stats->u32_heapPeak=mon.max_used;
+  stats->u32_heapBiggest=mon.free_biggest_size;
+  stats->u8_heapFrag=mon.frag_pct;
+  #if LV_MEM_CUSTOM
+  struct lvMemStats_s lvStats;
+  getLvMemStats(&lvStats);
+  stats->u32_heapInternal=lvStats.u32_internalBytes;
+  #else
+  stats->u32_heapInternal=stats->u32_heapUsed;
+  #endif
+  stats->u32_baseBytes=u32_mBaseBytes;
+  memcpy(stats->u32_tabBytes, u32_mTabBytes, sizeof(u32_mTabBytes));
+  memcpy(stats->u16_tabAllocs, u16_mTabAllocs, sizeof(u16_mTabAllocs));
 }
 
 
 unsigned int offTimer=0;
 unsigned long currentMillis;
 unsigned long previousMillis1000;
-void displayRunCyclic()
+static bool bo_mSleeping=false;
+
+//LVGL und Powersave; Rückgabe wie displayRunCyclic()
+static uint32_t runCyclic()
 {
-  lv_timer_handler(); 
+  uint32_t u32_lNextMs;
+
+  if(bo_mSleeping)
+  {
+    //Während das Panel schläft läuft LVGL nicht; nur der Touch wird langsam abgefragt
+    uint16_t touchX, touchY;
+    if(lcd.getTouch(&touchX, &touchY))
+    {
+      lcd.wakeup();
+      bo_mSleeping=false;
+      offTimer=0;
+      i2cRequestSnapshot();   //Der BSC hat während des Schlafens evtl. nichts gesendet
+      return 1;
+    }
+    return DISP_SLEEP_POLL_MS;
+  }
+
+  uint32_t u32_lStartUs = micros();
+  TRACE_BEGIN(TRACE_LVGL);
+  u32_lNextMs = lv_timer_handler(); 
+  TRACE_END(TRACE_LVGL);
+  uint32_t u32_lRunUs = micros()-u32_lStartUs;
+  u32_mLvglUs += u32_lRunUs;
+  latHistAdd(&lvglRun, u32_lRunUs);
 
   currentMillis = millis();
   if(currentMillis - previousMillis1000 >=1000)
   {
     if(offTimer<(u8_mPowersaveTime*60)) offTimer++;
-    if(offTimer>=(u8_mPowersaveTime*60)) lcd.sleep();
+    if(offTimer>=(u8_mPowersaveTime*60))
+    {
+      lcd.sleep();
+      bo_mSleeping=true;
+    }
 
     previousMillis1000 = currentMillis;
   }
-  
+
+  uint32_t u32_lSecMs = 1000-(currentMillis-previousMillis1000);
+  if(u32_lSecMs<u32_lNextMs) u32_lNextMs=u32_lSecMs;
+  if(u32_lNextMs==0) u32_lNextMs=1;
+
+  //Je Durchlauf höchstens einen weiteren Tab aufbauen, dann gleich wieder LVGL bedienen
+  if(buildIdleTab()) u32_lNextMs=1;
+  return u32_lNextMs;
+}
+
+
+//Rückgabe: Zeit in ms, nach der displayRunCyclic() spätestens wieder aufgerufen werden muss
+uint32_t displayRunCyclic()
+{
+  //Verspätung gegenüber der zuletzt gemeldeten Wartezeit. Frühere Aufrufe kommen von einer
+  //Benachrichtigung des I2C-Tasks und zählen nicht
+  uint32_t u32_lNowUs = micros();
+  if(u32_mDueUs!=0 && (int32_t)(u32_lNowUs-u32_mDueUs)>=0) latHistAdd(&loopLate, u32_lNowUs-u32_mDueUs);
+
+  uint32_t u32_lNextMs = runCyclic();
+
+  u32_mDueUs = micros()+u32_lNextMs*1000;
+  if(u32_mDueUs==0) u32_mDueUs=1;
+  return u32_lNextMs;
+}
+
+
+bool displayIsSleeping()
+{
+  return bo_mSleeping;
 }
 
 
+void getDisplayStats(struct displayStats_s *stats)
+{
+  stats->u32_displayedGen=u32_mDisplayedGen;
+  stats->u32_cyclesDrawn=u32_mCyclesDrawn;
+  stats->u32_cyclesSkipped=u32_mCyclesSkipped;
+  stats->u32_cyclesSuspect=u32_mCyclesSuspect;
+  stats->u32_firstDrawMs=u32_mBootMs[BOOT_FIRST_DATA];
+  memcpy(stats->u32_bootMs, u32_mBootMs, sizeof(u32_mBootMs));
+  stats->u32_pxPushed=u32_mPxPushed;
+  stats->u32_pxSkipped=u32_mPxSkipped;
+  stats->u32_refreshes=u32_mRefreshes;
+  stats->u32_flushUs=u32_mFlushUs;
+  stats->u32_lvglUs=u32_mLvglUs;
+  stats->loopLate=loopLate;
+  stats->lvglRun=lvglRun;
+}
+
+
+#ifdef DISP_TILE_DIFF
+//Neu zu zeichnende Bereiche auf das Kachelraster erweitern; zusammen mit DISP_BUF_LINES%DISP_TILE_H==0
+//beginnt dann jeder Streifen auf einer Kachelgrenze und jede Kachel wird immer ganz geprüft
+static void display_rounder(lv_disp_drv_t *disp, lv_area_t *area)
+{
+  area->x1 = area->x1 - area->x1%DISP_TILE_W;
+  area->y1 = area->y1 - area->y1%DISP_TILE_H;
+  area->x2 = min((int)screenWidth-1, area->x2 - area->x2%DISP_TILE_W + DISP_TILE_W-1);
+  area->y2 = min((int)screenHeight-1, area->y2 - area->y2%DISP_TILE_H + DISP_TILE_H-1);
+}
+
+
+/*
+ * Bereich in Kacheln zerlegen und je Kachel eine Prüfsumme bilden. Unveränderte Kacheln
+ * werden nicht übertragen, benachbarte geänderte Kacheln einer Kachelzeile am Stück.
+ * Rückgabe true: alle Kacheln geändert, der Aufrufer überträgt den ganzen Bereich.
+ */
+static bool flushChangedTiles(const lv_area_t *area, lv_color_t *color_p)
+{
+  uint32_t w = (area->x2 - area->x1 + 1);
+  uint16_t u16_lTx0 = area->x1/DISP_TILE_W;
+  uint16_t u16_lTx1 = area->x2/DISP_TILE_W;
+  uint16_t u16_lTy0 = area->y1/DISP_TILE_H;
+  uint16_t u16_lTy1 = area->y2/DISP_TILE_H;
+  static bool bo_lChanged[DISP_TILES_X];
+  bool bo_lAllChanged=true;
+  bool bo_lStarted=false;
+
+  for(uint16_t ty=u16_lTy0;ty<=u16_lTy1;ty++)
+  {
+    uint16_t y0 = max((int)area->y1, ty*DISP_TILE_H);
+    uint16_t y1 = min((int)area->y2, ty*DISP_TILE_H+DISP_TILE_H-1);
+
+    for(uint16_t tx=u16_lTx0;tx<=u16_lTx1;tx++)
+    {
+      uint16_t x0 = max((int)area->x1, tx*DISP_TILE_W);
+      uint16_t x1 = min((int)area->x2, tx*DISP_TILE_W+DISP_TILE_W-1);
+
+      //FNV-1a über die Pixel des Ausschnitts
+      uint32_t u32_lHash = 2166136261UL;
+      for(uint16_t y=y0;y<=y1;y++)
+      {
+        const lv_color_t *row = &color_p[(y-area->y1)*w + (x0-area->x1)];
+        for(uint16_t x=0;x<=x1-x0;x++) u32_lHash = (u32_lHash ^ row[x].full) * 16777619UL;
+      }
+
+      struct dispTile_s *tile = &dispTiles[ty][tx];
+      bo_lChanged[tx] = (tile->u32_hash!=u32_lHash || tile->u16_x1!=x0 || tile->u16_y1!=y0 || tile->u16_x2!=x1 || tile->u16_y2!=y1);
+      tile->u32_hash=u32_lHash;
+      tile->u16_x1=x0;
+      tile->u16_y1=y0;
+      tile->u16_x2=x1;
+      tile->u16_y2=y1;
+      if(!bo_lChanged[tx]) bo_lAllChanged=false;
+    }
+
+    if(bo_lAllChanged) continue; //Noch keine unveränderte Kachel; ggf. später ganz übertragen
+
+    //Ab der ersten unveränderten Kachel selbst übertragen; frühere Kachelzeilen nachholen
+    for(uint16_t ty2=(bo_lStarted ? ty : u16_lTy0);ty2<=ty;ty2++)
+    {
+      uint16_t y0b = max((int)area->y1, ty2*DISP_TILE_H);
+      uint16_t y1b = min((int)area->y2, ty2*DISP_TILE_H+DISP_TILE_H-1);
+
+      if(!bo_lStarted)
+      {
+        lcd.startWrite();
+        lcd.waitDMA();
+        bo_lStarted=true;
+      }
+
+      uint16_t tx=u16_lTx0;
+      while(tx<=u16_lTx1)
+      {
+        //Frühere Kachelzeilen waren vollständig geändert
+        bool bo_lRowChanged = (ty2<ty) ? true : bo_lChanged[tx];
+        uint16_t x0 = max((int)area->x1, tx*DISP_TILE_W);
+        uint16_t x1 = min((int)area->x2, tx*DISP_TILE_W+DISP_TILE_W-1);
+
+        if(!bo_lRowChanged)
+        {
+          u32_mPxSkipped += (uint32_t)(x1-x0+1)*(y1b-y0b+1);
+          tx++;
+          continue;
+        }
+
+        //Lauf benachbarter geänderter Kacheln
+        while(tx+1<=u16_lTx1 && ((ty2<ty) || bo_lChanged[tx+1])) tx++;
+        x1 = min((int)area->x2, tx*DISP_TILE_W+DISP_TILE_W-1);
+        tx++;
+
+        lcd.setAddrWindow(x0, y0b, x1-x0+1, y1b-y0b+1);
+        for(uint16_t y=y0b;y<=y1b;y++)
+        {
+          lcd.pushPixels((uint16_t *)&color_p[(y-area->y1)*w + (x0-area->x1)].full, x1-x0+1, DISP_PIXEL_SWAP);
+        }
+        u32_mPxPushed += (uint32_t)(x1-x0+1)*(y1b-y0b+1);
+      }
+    }
+  }
+
+  if(bo_lStarted) lcd.endWrite();
+  return bo_lAllChanged;
+}
+#endif
+
+
 // Display callback to flush the buffer to screen
+//Ende des Flush-Callbacks: Zeiten erfassen und LVGL den Puffer zurückgeben
+static void flushDone(lv_disp_drv_t *disp, uint32_t u32_lFlushStart)
+{
+  u32_mFlushUs += micros()-u32_lFlushStart;
+  if(lv_disp_flush_is_last(disp))
+  {
+    u32_mRefreshes++;
+    if(u32_mBootMs[BOOT_FIRST_FLUSH]==0) bootPhase(BOOT_FIRST_FLUSH);
+  }
+  TRACE_END(TRACE_FLUSH);
+  lv_disp_flush_ready(disp);
+}
+
+
 void display_flush(lv_disp_drv_t * disp, const lv_area_t *area, lv_color_t *color_p)
 {
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
+  uint32_t u32_lFlushStart = micros();
+  TRACE_BEGIN(TRACE_FLUSH);
 
-  lcd.startWrite();
-  lcd.setAddrWindow(area->x1, area->y1, w, h);
-  lcd.pushPixels((uint16_t *)&color_p->full, w * h, true);
-  lcd.endWrite();
+  #ifdef DISP_TILE_DIFF
+  if(!flushChangedTiles(area, color_p))
+  {
+    //Geänderte Kacheln sind bereits übertragen; ggf. den über den Refresh reservierten Bus freigeben
+    if(lv_disp_flush_is_last(disp) && lcd.getStartCount()>0) lcd.endWrite();
+    flushDone(disp, u32_lFlushStart);
+    return;
+  }
+  #endif
 
-  lv_disp_flush_ready(disp);
+  u32_mPxPushed += w*h;
+
+  if(!bo_mFlushDma)
+  {
+    lcd.startWrite();
+    lcd.setAddrWindow(area->x1, area->y1, w, h);
+    lcd.pushPixels((uint16_t *)&color_p->full, w * h, DISP_PIXEL_SWAP);
+    lcd.endWrite();
+
+    flushDone(disp, u32_lFlushStart);
+    return;
+  }
+
+  #ifdef DISP_MEASURE_FLUSH
+  uint32_t u32_lEntry = micros();
+  bool bo_lBusy = lcd.dmaBusy();
+  #endif
+
+  /*
+   * Der Bus bleibt über den ganzen Refresh reserviert. Bevor der neue Transfer startet,
+   * wird auf das Ende des vorherigen gewartet; erst dann ist dessen Puffer wieder frei.
+   * Da LVGL erst nach lv_disp_flush_ready() in den jeweils anderen Puffer rendert,
+   * wird dieser Puffer nie gleichzeitig gelesen und beschrieben.
+   */
+  if(lcd.getStartCount()==0) lcd.startWrite();
+  TRACE_BEGIN(TRACE_FLUSH_WAIT);
+  lcd.waitDMA();
+  TRACE_END(TRACE_FLUSH_WAIT);
+
+  #ifdef DISP_MEASURE_FLUSH
+  uint32_t u32_lDmaEnd = (bo_lBusy) ? micros() : u32_lEntry;
+  if(u32_mDmaStart!=0)
+  {
+    u32_mBusUs += u32_lDmaEnd-u32_mDmaStart;
+    u32_mOverlapUs += u32_lEntry-u32_mDmaStart;
+  }
+  u32_mDmaStart = micros();
+  #endif
+
+  lcd.pushImageDMA(area->x1, area->y1, w, h, (dispPixel_t *)&color_p->full);
+
+  //Letzter Bereich dieses Refresh: Bus wieder freigeben (wartet intern auf das DMA-Ende)
+  if(lv_disp_flush_is_last(disp))
+  {
+    lcd.endWrite();
+    #ifdef DISP_MEASURE_FLUSH
+    u32_mBusUs += micros()-u32_mDmaStart;
+    u32_mDmaStart = 0;
+    #endif
+  }
+
+  #ifdef DISP_MEASURE_FLUSH
+  u32_mBlockedUs += micros()-u32_lEntry;
+  #endif
+
+  flushDone(disp, u32_lFlushStart);
+}
+
+
+#ifdef DISP_MEASURE_FLUSH
+//Wird von LVGL nach jedem Refresh aufgerufen; time = Render- und Flushzeit in ms
+void display_monitor(lv_disp_drv_t *disp, uint32_t time, uint32_t px)
+{
+  uint32_t u32_lRenderUs = (time*1000 > u32_mBlockedUs) ? time*1000-u32_mBlockedUs : 0;
+  Serial.printf("refr: %u ms, px: %u, render: %u us, flush: %u us, blocked: %u us, overlap: %u us\n",
+    time, px, u32_lRenderUs, u32_mBusUs, u32_mBlockedUs, u32_mOverlapUs);
+
+  u32_mBusUs=0;
+  u32_mBlockedUs=0;
+  u32_mOverlapUs=0;
 }
+#endif
 
 
 // Touchpad callback to read the touchpad 
@@ -137,7 +650,6 @@ void touchpad_read(lv_indev_drv_t * indev_driver, lv_indev_data_t * data)
     data->point.y = touchY;
     //Serial.printf("Touch (x,y): (%03d,%03d)\n",touchX,touchY);
 
-    if(offTimer>=(u8_mPowersaveTime*60)) lcd.wakeup(); 
     offTimer=0;
   }
 }
@@ -170,6 +682,15 @@ static void draw_part_event_cb(lv_event_t * e)
     }
 }
 
+static void tab_changed_event(lv_event_t* e)
+{
+    /*Änderungen, die aufgelaufen sind während der Tab versteckt war, in einem Durchgang nachziehen*/
+    if (lv_event_get_code(e) == LV_EVENT_VALUE_CHANGED) {
+        buildTab(lv_tabview_get_tab_act(tabview));
+        renderTab(lv_tabview_get_tab_act(tabview));
+    }
+}
+
 static void scroll_begin_event(lv_event_t* e)
 {
     /*Disable the scroll animations. Triggered when a tab button is clicked */
@@ -183,10 +704,12 @@ static void scroll_begin_event(lv_event_t* e)
 
 void createScreens(void)
 {
-  lv_obj_t * tabview;
+  memMonitor(&memMark);
+
   tabview = lv_tabview_create(lv_scr_act(), LV_DIR_LEFT, 60);
   lv_obj_clear_flag(lv_tabview_get_content(tabview), LV_OBJ_FLAG_SCROLLABLE);
   lv_obj_add_event_cb(lv_tabview_get_content(tabview), scroll_begin_event,LV_EVENT_SCROLL_BEGIN, NULL);
+  lv_obj_add_event_cb(tabview, tab_changed_event, LV_EVENT_VALUE_CHANGED, NULL);
 
   lv_obj_t * tab_btns = lv_tabview_get_tab_btns(tabview);
   lv_obj_set_style_bg_color(tab_btns, lv_palette_darken(LV_PALETTE_GREY, 3), 0);
@@ -205,44 +728,83 @@ void createScreens(void)
 
   //Styles
   //line
-  static lv_style_t style_line;
   lv_style_init(&style_line);
   lv_style_set_line_width(&style_line, 2);
   lv_style_set_line_color(&style_line, lv_palette_main(LV_PALETTE_BLUE));
 
   //line2
-  static lv_style_t style_line2;
   lv_style_init(&style_line2);
   lv_style_set_line_width(&style_line2, 1);
   lv_style_set_line_color(&style_line2, lv_palette_main(LV_PALETTE_GREY));
 
   //Fontsytle: big
-  static lv_style_t style_font1;
   lv_style_init(&style_font1);
   lv_style_set_text_font(&style_font1, &lv_font_montserrat_24);
 
   //Sytle: Kachel
-  static lv_style_t style_kachel;
   lv_style_init(&style_kachel);
   lv_style_set_border_width(&style_kachel,0);
   lv_style_set_radius(&style_kachel,0);
   lv_style_set_bg_color(&style_kachel,LV_COLOR_MAKE(0xe0, 0xee, 0xee));
 
   //Fontsytle: Kachel
-  static lv_style_t style_fontKachel;
   lv_style_init(&style_fontKachel);
   lv_style_set_text_font(&style_fontKachel, &lv_font_montserrat_16);
 
+  memTabDone(TAB_COUNT);
+}
 
-  //Objects
-  lv_obj_t * label;
-  lv_obj_t * line1;
-  lv_obj_t * kachel;
 
+static void (*const tabBuilders[TAB_COUNT])() = {buildTabHome, buildTabSerBms, buildTabBtBms, buildTabZellSpg, buildTabInfo};
+
+//Inhalt eines Tabs anlegen, falls noch nicht geschehen; danach wird er beim nächsten renderTab() vollständig gezeichnet
+static void buildTab(uint8_t u8_lTab)
+{
+  if(u8_lTab>=TAB_COUNT || bo_mTabBuilt[u8_lTab]) return;
+
+  memMonitor(&memMark);
+  tabBuilders[u8_lTab]();
+  memTabDone(u8_lTab);
+  bo_mTabBuilt[u8_lTab]=true;
+  memset(&tabDirty[u8_lTab], 0xFF, sizeof(struct dataDirty_s));
+
+  for(uint8_t t=0;t<TAB_COUNT;t++) if(!bo_mTabBuilt[t]) return;
+  bootPhase(BOOT_ALL_TABS);
+
+  struct displayMemStats_s memStats;
+  getDisplayMemStats(&memStats);
+  Serial.printf("LVGL heap: %u/%u B, internal %u B, base %u B, tabs %u %u %u %u %u B\n", memStats.u32_heapUsed, memStats.u32_heapSize,
+    memStats.u32_heapInternal, memStats.u32_baseBytes, memStats.u32_tabBytes[TAB_HOME], memStats.u32_tabBytes[TAB_SER_BMS], memStats.u32_tabBytes[TAB_BT_BMS],
+    memStats.u32_tabBytes[TAB_ZELL_SPG], memStats.u32_tabBytes[TAB_INFO]);
+  if(memStats.u32_heapSize-memStats.u32_heapUsed < memStats.u32_heapSize/100*DISP_LV_MEM_RESERVE_PCT)
+  {
+    Serial.println("Display: LVGL heap reserve low");
+  }
+}
+
+
+//Nach dem ersten Bild den nächsten fehlenden Tab aufbauen; true, wenn einer aufgebaut wurde
+static bool buildIdleTab()
+{
+  if(u32_mBootMs[BOOT_FIRST_FLUSH]==0 || u32_mBootMs[BOOT_ALL_TABS]!=0) return false;
+
+  for(uint8_t t=0;t<TAB_COUNT;t++)
+  {
+    if(bo_mTabBuilt[t]) continue;
+    buildTab(t);
+    return true;
+  }
+  return false;
+}
+
+
+/****************************************
+ * Tab HOME
+ ****************************************/
+static void buildTabHome()
+{
+  lv_obj_t * label;
 
-  /****************************************
-   * Tab HOME
-   ****************************************/
   label = lv_label_create(tabHome);
   lv_label_set_recolor(label, true);
   lv_obj_add_style(label, &style_font1, 0);
@@ -371,21 +933,26 @@ void createScreens(void)
     lv_label_set_text_fmt(label, "Rel %i",i+1);
     lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
   }
+}
+
+
+/****************************************
+ * Tab Serial-BMS Overview
+ ****************************************/
+static void buildTabSerBms()
+{
+  lv_obj_t * label;
+  lv_obj_t * line1;
 
-  
-  /****************************************
-   * Tab Serial-BMS Overview
-   ****************************************/
   uint16_t xPos=0, yPos=0, bmsNr=0;
 
   label = lv_label_create(tabSerBmsOverview);
   lv_label_set_text_fmt(label, "\n\nSpg. (V)\nCur. (A)\nSoC (%%)\nMax Cell\n(mV)\nMin Cell\n(mV)\nMax Cell\nDiff (mV)\nTemp °C\nBalance\nFehler");
   lv_obj_align(label, LV_ALIGN_TOP_LEFT, 0, 0);
     
-  for(uint8_t n=5;n<8;n++)
+  for(uint8_t n=0;n<SERIAL_BMS_DEVICES_COUNT;n++)
   {
-    xPos=44*(n-5)+70;
-    if(n>4)xPos+=2;
+    xPos=overviewColX(n, true);
     label = lv_label_create(tabSerBmsOverview);
     lv_label_set_text_fmt(label, "S%d",bmsNr);
     lv_obj_align(label, LV_ALIGN_TOP_LEFT, xPos, yPos);
@@ -394,31 +961,34 @@ void createScreens(void)
 
   //Draw line horizontal
   line1 = lv_line_create(tabSerBmsOverview);
-  static lv_point_t line_points4[] = {{0, 22}, {198, 22}};
+  static lv_point_t line_points4[] = {{0, 22}, {overviewLineEnd(SERIAL_BMS_DEVICES_COUNT), 22}};
   lv_line_set_points(line1, line_points4, 2);
   lv_obj_add_style(line1, &style_line, 0);
 
   //Draw line vertical
   line1 = lv_line_create(tabSerBmsOverview);
-  static lv_point_t line_points5[] = {{66, 0}, {66, 228}};
+  static lv_point_t line_points5[] = {{OVERVIEW_LABEL_W, 0}, {OVERVIEW_LABEL_W, overviewHeight()}};
   lv_line_set_points(line1, line_points5, 2);   
   lv_obj_add_style(line1, &style_line, 0);
+}
 
 
+/****************************************
+ * Tab BT-BMS Overview
+ ****************************************/
+static void buildTabBtBms()
+{
+  lv_obj_t * label;
+  lv_obj_t * line1;
 
-  /****************************************
-   * Tab BT-BMS Overview
-   ****************************************/
   label = lv_label_create(tabBTBmsOverview);
   lv_label_set_text_fmt(label, "\n\nSpg. (V)\nCur. (A)\nSoC (%%)\nMax Cell\n(mV)\nMin Cell\n(mV)\nMax Cell\nDiff (mV)\nTemp °C\nBalance\nFehler");
   lv_obj_align(label, LV_ALIGN_TOP_LEFT, 0, 0);
   
-  yPos=0;
-  bmsNr=0;
-  for(uint8_t n=0;n<5;n++)
+  uint16_t xPos=0, yPos=0, bmsNr=0;
+  for(uint8_t n=0;n<BT_DEVICES_COUNT;n++)
   {
-    xPos=44*n+70;
-    if(n>4)xPos+=2;
+    xPos=overviewColX(n, false);
     label = lv_label_create(tabBTBmsOverview);
     lv_label_set_text_fmt(label, "Bt%d",bmsNr);
     lv_obj_align(label, LV_ALIGN_TOP_LEFT, xPos, yPos);
@@ -427,71 +997,85 @@ void createScreens(void)
 
   //Draw line horizontal
   line1 = lv_line_create(tabBTBmsOverview);
-  static lv_point_t line_points6[] = {{0, 22}, {286, 22}};
+  static lv_point_t line_points6[] = {{0, 22}, {overviewLineEnd(BT_DEVICES_COUNT), 22}};
   lv_line_set_points(line1, line_points6, 2);   
   lv_obj_add_style(line1, &style_line, 0);
 
   //Draw line vertical
   line1 = lv_line_create(tabBTBmsOverview);
-  static lv_point_t line_points7[] = {{66, 0}, {66, 228}};
+  static lv_point_t line_points7[] = {{OVERVIEW_LABEL_W, 0}, {OVERVIEW_LABEL_W, overviewHeight()}};
   lv_line_set_points(line1, line_points7, 2);   
   lv_obj_add_style(line1, &style_line, 0);
+}
 
 
-  /****************************************
-   * Tab Zellspannungen
-   ****************************************/
-  label = lv_label_create(tabZellSpg);
-  lv_label_set_text_fmt(label, "%s\n\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d","mV",1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16);
-  lv_obj_align(label, LV_ALIGN_TOP_LEFT, 0, 0);
+/****************************************
+ * Tab Zellspannungen
+ ****************************************/
+static void buildTabZellSpg()
+{
+  lv_obj_t * label;
+  lv_obj_t * line1;
 
-  //Bluetooth
-  uint8_t n;
-  bmsNr=0;
-  for(n=0;n<5;n++)
+  //Zellnummern
+  char *p=fmtStr(txtBuf, "mV\n");
+  for(uint8_t c=0;c<DISP_CELL_COUNT;c++)
   {
-    xPos=44*n+33;
-    if(n>4)xPos+=8;
-    label = lv_label_create(tabZellSpg);
-    lv_label_set_text_fmt(label, "Bt%d",bmsNr);
-    lv_obj_align(label, LV_ALIGN_TOP_LEFT, xPos, 0);
-    bmsNr++;
+    p=fmtStr(p, "\n");
+    p=fmtUInt(p, c+1);
   }
+  label = lv_label_create(tabZellSpg);
+  lv_label_set_text(label, txtBuf);
+  lv_obj_align(label, LV_ALIGN_TOP_LEFT, 0, 0);
 
-  //Serial
-  for(uint8_t s=n;s<8;s++)
+  //Kopfzeile; Serial BMS werden mit "S" benannt und ab 0 gezählt
+  for(uint8_t i=0;i<BMS_DEVICES_COUNT;i++)
   {
-    xPos=44*s+33;
-    if(s>4)xPos+=8;
     label = lv_label_create(tabZellSpg);
-    lv_label_set_text_fmt(label, "S%d",bmsNr-5);
-    lv_obj_align(label, LV_ALIGN_TOP_LEFT, xPos, 0);
-    bmsNr++;
+    if(i<BT_DEVICES_COUNT) lv_label_set_text_fmt(label, "Bt%d",i);
+    else lv_label_set_text_fmt(label, "S%d",i-BT_DEVICES_COUNT);
+    lv_obj_align(label, LV_ALIGN_TOP_LEFT, zellColX(i), 0);
   }
 
+  //Zellen; Texte stehen in cellTxt, gezeichnet wird in cellGridDraw()
+  cellGrid = lv_obj_create(tabZellSpg);
+  lv_obj_remove_style_all(cellGrid);
+  lv_obj_clear_flag(cellGrid, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_clear_flag(cellGrid, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_set_pos(cellGrid, 0, 0);
+  lv_obj_set_size(cellGrid, zellColX(BMS_DEVICES_COUNT-1)+COL_W, zellRowY(DISP_CELL_COUNT));
+  lv_obj_add_event_cb(cellGrid, cellGridDraw, LV_EVENT_DRAW_MAIN, NULL);
+
   //Draw line top horizontal
   line1 = lv_line_create(tabZellSpg);
-  static lv_point_t line_points[] = {{0, 22}, {385, 22}};
+  static lv_point_t line_points[] = {{0, 22}, {COL_W*BMS_DEVICES_COUNT+ZELL_X0, 22}};
   lv_line_set_points(line1, line_points, 2);   
   lv_obj_add_style(line1, &style_line, 0);
 
   //Draw line left vertical
   line1 = lv_line_create(tabZellSpg);
-  static lv_point_t line_points2[] = {{28, 0}, {28, 285}};
+  static lv_point_t line_points2[] = {{28, 0}, {28, zellHeight()}};
   lv_line_set_points(line1, line_points2, 2);   
   lv_obj_add_style(line1, &style_line, 0);
 
-  //Draw line right vertical
-  line1 = lv_line_create(tabZellSpg);
-  static lv_point_t line_points3[] = {{253, 0}, {253, 285}};
-  lv_line_set_points(line1, line_points3, 2);   
-  lv_obj_add_style(line1, &style_line2, 0);
+  //Draw line vertical zwischen Bluetooth- und Serial-BMS
+  if(BT_DEVICES_COUNT>0 && SERIAL_BMS_DEVICES_COUNT>0)
+  {
+    line1 = lv_line_create(tabZellSpg);
+    static lv_point_t line_points3[] = {{COL_W*BT_DEVICES_COUNT+ZELL_X0, 0}, {COL_W*BT_DEVICES_COUNT+ZELL_X0, zellHeight()}};
+    lv_line_set_points(line1, line_points3, 2);   
+    lv_obj_add_style(line1, &style_line2, 0);
+  }
+}
 
 
-  /****************************************
-   * Tab Info
-   ****************************************/
-  
+/****************************************
+ * Tab Info
+ ****************************************/
+static void buildTabInfo()
+{
+  lv_obj_t * label;
+
   //Headline
   label = lv_label_create(tabInfo);
   lv_label_set_recolor(label, true);
@@ -561,184 +1145,448 @@ void createScreens(void)
   label = lv_label_create(tabInfo);
   lv_label_set_text(label, "https://github.com/shining-man/bsc_fw\n          https://www.BSC-Shop.com");
   lv_obj_align(label, LV_ALIGN_BOTTOM_MID, 0, 0);
+
+  //Diagnose; Schalter und Feld, standardmäßig aus
+  lv_obj_t * diagSwitch = lv_switch_create(tabInfo);
+  lv_obj_align(diagSwitch, LV_ALIGN_TOP_LEFT, 0, 50);
+  lv_obj_add_event_cb(diagSwitch, diagSwitchEvent, LV_EVENT_VALUE_CHANGED, NULL);
+
+  label = lv_label_create(tabInfo);
+  lv_label_set_text(label, "Diagnose");
+  lv_obj_align(label, LV_ALIGN_TOP_LEFT, 60, 53);
+
+  diagPanel = lv_obj_create(tabInfo);
+  lv_obj_add_style(diagPanel, &style_kachel, 0);
+  lv_obj_set_size(diagPanel, lv_pct(100), 150);
+  lv_obj_align(diagPanel, LV_ALIGN_TOP_LEFT, 0, 85);
+  lv_obj_clear_flag(diagPanel, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_flag(diagPanel, LV_OBJ_FLAG_HIDDEN);
+
+  diagLabel = lv_label_create(diagPanel);
+  lv_label_set_text(diagLabel, "");
+  lv_obj_align(diagLabel, LV_ALIGN_TOP_LEFT, 0, 0);
+
+  diagTimer = lv_timer_create(diagTimerCb, DISP_DIAG_PERIOD_MS, NULL);
+  lv_timer_pause(diagTimer);
 }
 
 
-void displayNewBscData()
+//Text nur setzen, wenn er sich vom angezeigten unterscheidet (spart Layout und Invalidierung)
+static void setLabelText(lv_obj_t *label, const char *text)
+{
+  if(strcmp(lv_label_get_text(label), text)==0) return;
+  lv_label_set_text(label, text);
+}
+
+
+//Ausgangswerte für die Raten merken
+static void diagSnapshot()
+{
+  getI2cStats(&diagI2c);
+  getDisplayStats(&diagDisp);
+  u32_mDiagGen=getPublishedGeneration();
+  u32_mDiagMs=millis();
+}
+
+
+static void diagSwitchEvent(lv_event_t *e)
+{
+  if(lv_event_get_code(e)!=LV_EVENT_VALUE_CHANGED) return;
+
+  if(lv_obj_has_state(lv_event_get_target(e), LV_STATE_CHECKED))
+  {
+    diagSnapshot();
+    setLabelText(diagLabel, "...");
+    lv_obj_clear_flag(diagPanel, LV_OBJ_FLAG_HIDDEN);
+    lv_timer_resume(diagTimer);
+  }
+  else
+  {
+    lv_timer_pause(diagTimer);
+    lv_obj_add_flag(diagPanel, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+
+//Wert je Sekunde mit einer Nachkommastelle
+static char *fmtRate(char *p, uint32_t u32_lDelta, uint32_t u32_lMs)
 {
-  if(!hasNewDisplayData()) return;
+  return fmtFixed(p, (int32_t)(u32_lDelta*10000ULL/u32_lMs), 1, 1);
+}
+
+
+static void diagTimerCb(lv_timer_t *timer)
+{
+  (void)timer;
+  if(lv_tabview_get_tab_act(tabview)!=TAB_INFO)
+  {
+    //Tab nicht sichtbar: nichts anzeigen, die Raten beim Zurückwechseln aber nicht über die ganze Pause mitteln
+    diagSnapshot();
+    return;
+  }
+
+  struct i2cStats_s i2cStats;
+  struct displayStats_s dispStats;
+  getI2cStats(&i2cStats);
+  getDisplayStats(&dispStats);
+  uint32_t u32_lGen = getPublishedGeneration();
+  uint32_t u32_lMs = millis()-u32_mDiagMs;
+  if(u32_lMs==0) return;
+
+  uint32_t u32_lDrops = i2cStats.u32_ringOverflow+i2cStats.u32_dropOversize+i2cStats.u32_dropShort+
+    i2cStats.u32_dropUnknown+i2cStats.u32_dropBmsNr+i2cStats.u32_dropPayload+i2cStats.u32_crcErrors;
+  uint32_t u32_lRefr = dispStats.u32_refreshes-diagDisp.u32_refreshes;
+  uint32_t u32_lFlushUs = dispStats.u32_flushUs-diagDisp.u32_flushUs;
+  uint32_t u32_lLvglUs = dispStats.u32_lvglUs-diagDisp.u32_lvglUs;
+  uint32_t u32_lRenderUs = (u32_lLvglUs>u32_lFlushUs) ? u32_lLvglUs-u32_lFlushUs : 0;
+  if(u32_lRefr==0) u32_lRefr=1;
+
+  struct displayMemStats_s memStats;
+  getDisplayMemStats(&memStats);
+
+  char *p=fmtStr(diagBuf, "I2C: ");
+  p=fmtRate(p, i2cStats.u32_rxFrames-diagI2c.u32_rxFrames, u32_lMs);
+  p=fmtStr(p, " Frames/s, ");
+  p=fmtRate(p, u32_lGen-u32_mDiagGen, u32_lMs);
+  p=fmtStr(p, " Zyklen/s, Drops ");
+  p=fmtUInt(p, u32_lDrops);
+  p=fmtStr(p, "\nAnzeige: ");
+  p=fmtRate(p, dispStats.u32_cyclesDrawn-diagDisp.u32_cyclesDrawn, u32_lMs);
+  p=fmtStr(p, " Zyklen/s, ");
+  p=fmtRate(p, dispStats.u32_refreshes-diagDisp.u32_refreshes, u32_lMs);
+  p=fmtStr(p, " Refresh/s\nRender ");
+  p=fmtFixed(p, u32_lRenderUs/u32_lRefr, 3, 1);
+  p=fmtStr(p, " ms, Flush ");
+  p=fmtFixed(p, u32_lFlushUs/u32_lRefr, 3, 1);
+  p=fmtStr(p, " ms, ");
+  p=fmtUInt(p, (uint32_t)((uint64_t)(dispStats.u32_pxPushed-diagDisp.u32_pxPushed)*1000/u32_lMs));
+  p=fmtStr(p, " px/s\nLVGL-Heap: ");
+  p=fmtUInt(p, memStats.u32_heapUsed);
+  p=fmtStr(p, " / ");
+  p=fmtUInt(p, memStats.u32_heapSize);
+  p=fmtStr(p, " B, max ");
+  p=fmtUInt(p, memStats.u32_heapPeak);
+  p=fmtStr(p, ", Block ");
+  p=fmtUInt(p, memStats.u32_heapBiggest);
+  p=fmtStr(p, ", Frag. ");
+  p=fmtUInt(p, memStats.u8_heapFrag);
+  p=fmtStr(p, " %\nStack frei: i2c ");
+  p=fmtUInt(p, i2cStats.u32_stackFree);
+  p=fmtStr(p, " B, display ");
+  p=fmtUInt(p, uxTaskGetStackHighWaterMark(NULL));
+  p=fmtStr(p, " B");
+  setLabelText(diagLabel, diagBuf);
+
+  diagI2c=i2cStats;
+  diagDisp=dispStats;
+  u32_mDiagGen=u32_lGen;
+  u32_mDiagMs+=u32_lMs;
+}
 
+
+static void renderTabHome(struct dataDirty_s *lDirty)
+{
   lv_obj_t *label;
-  uint8_t u8_lObjCnt;
   bool bo_lBmsHasError=false;
+  bool bo_lBmsStatusDirty=false;
+
+  for(uint8_t i=0;i<BMS_DEVICES_COUNT;i++)
+  {
+    if(lDataDisp->bmsErrors[i]>0) bo_lBmsHasError=true;
+    if(lDirty->u8_bms[i]&DIRTY_BMS_STATUS) bo_lBmsStatusDirty=true;
+  }
 
   /****************************************
    * Tab Home Overview
    ****************************************/
   //Kachel1; Alarme 
-  label = lv_obj_get_child(kachelAlarme, 2);
-  uint16_t u16_lAlarme = lDataDisp->bscAlarms;
-  uint8_t alms[10];
-  for(uint8_t i=0;i<10;i++)
+  if(lDirty->u8_global&DIRTY_BSC_ALARMS)
   {
-    if((u16_lAlarme & (1<<i)) == (1<<i)) alms[i]=1;
-    else alms[i]=0;
+    label = lv_obj_get_child(kachelAlarme, 2);
+    uint16_t u16_lAlarme = lDataDisp->bscAlarms;
+    char *p=txtBuf;
+    for(uint8_t i=0;i<10;i++)
+    {
+      *p++ = ((u16_lAlarme>>i)&0x1) ? '1' : '0';
+      if(i==4) *p++='\n';
+      else if(i<9) p=fmtStr(p, "  ");
+    }
+    *p='\0';
+    setLabelText(label, txtBuf);
   }
-  lv_label_set_text_fmt(label, "%d  %d  %d  %d  %d\n%d  %d  %d  %d  %d",
-    alms[0],alms[1],alms[2],alms[3],alms[4],alms[5],alms[6],alms[7],alms[8],alms[9]);
 
   //Kachel2; BMS Status
-  label = lv_obj_get_child(kachelBmsError, 1);
-  lv_label_set_recolor(label, true);
-  if(bo_lBmsHasError) lv_label_set_text_fmt(label, "#FF0000 Error#");
-  else lv_label_set_text_fmt(label, "#00FF00 OK#");
-  //lv_label_set_text(labelDisp, "test");
-
-  //Kachel3; Inverter 
-  label = lv_obj_get_child(kachelInverter, 2);
-  lv_label_set_text_fmt(label, "%.2f V\n%.2f A\n%d %%",lDataDisp->inverterVoltage/100.0,lDataDisp->inverterCurrent/10.0,lDataDisp->inverterSoc);
+  if(bo_lBmsStatusDirty)
+  {
+    label = lv_obj_get_child(kachelBmsError, 1);
+    lv_label_set_recolor(label, true);
+    if(bo_lBmsHasError) setLabelText(label, "#FF0000 Error#");
+    else setLabelText(label, "#00FF00 OK#");
+  }
 
-  //Kachel4; Inverter 2
-  label = lv_obj_get_child(kachelInverter2, 3);
-  lv_label_set_text_fmt(label, "%d A\n%d A\n",lDataDisp->inverterChargeCurrent,lDataDisp->inverterDischargeCurrent);
+  if(lDirty->u8_global&DIRTY_INVERTER)
+  {
+    //Kachel3; Inverter 
+    label = lv_obj_get_child(kachelInverter, 2);
+    char *p=txtBuf;
+    p=fmtFixed(p, lDataDisp->inverterVoltage, 2, 2);
+    p=fmtStr(p, " V\n");
+    p=fmtFixed(p, lDataDisp->inverterCurrent, 1, 2);
+    p=fmtStr(p, " A\n");
+    p=fmtUInt(p, lDataDisp->inverterSoc);
+    p=fmtStr(p, " %");
+    setLabelText(label, txtBuf);
+
+    //Kachel4; Inverter 2
+    label = lv_obj_get_child(kachelInverter2, 3);
+    p=txtBuf;
+    p=fmtInt(p, lDataDisp->inverterChargeCurrent);
+    p=fmtStr(p, " A\n");
+    p=fmtInt(p, lDataDisp->inverterDischargeCurrent);
+    p=fmtStr(p, " A\n");
+    setLabelText(label, txtBuf);
+  }
 
   //Relais
-  uint8_t u8_lRelais = lDataDisp->bscRelais;
-  uint8_t u8_lRelNr=0;
-  for(uint8_t i=0;i<6;i++)
+  if(lDirty->u8_global&DIRTY_BSC_RELAIS)
   {
-    if((u8_lRelais>>i)&0x1) lv_obj_set_style_bg_color(relaisState[u8_lRelNr],LV_COLOR_MAKE(0xff, 0x00, 0x00),LV_PART_MAIN);
-    else lv_obj_set_style_bg_color(relaisState[u8_lRelNr],LV_COLOR_MAKE(0x00, 0xff, 0x00),LV_PART_MAIN);
-    u8_lRelNr++;
+    uint8_t u8_lRelais = lDataDisp->bscRelais;
+    uint8_t u8_lRelNr=0;
+    for(uint8_t i=0;i<6;i++)
+    {
+      if((u8_lRelais>>i)&0x1) lv_obj_set_style_bg_color(relaisState[u8_lRelNr],LV_COLOR_MAKE(0xff, 0x00, 0x00),LV_PART_MAIN);
+      else lv_obj_set_style_bg_color(relaisState[u8_lRelNr],LV_COLOR_MAKE(0x00, 0xff, 0x00),LV_PART_MAIN);
+      u8_lRelNr++;
+    }
   }
+}
 
 
-  /****************************************
-   * Tab Serial-BMS Overview
-   ****************************************/
-  u8_lObjCnt=1;
-  String str_lIsBalance, str_lError;
+//Spaltenweise Übersicht der BMS u8_lFirst..u8_lLast-1; Spalte zeigt Totals, Temperatur und Status
+static void renderTabBmsOverview(struct dataDirty_s *lDirty, lv_obj_t *tab, uint8_t u8_lFirst, uint8_t u8_lLast, const char *devType)
+{
+  lv_obj_t *label;
+  uint8_t u8_lObjCnt=1;
   
-  for(uint8_t i=5;i<8;i++)
+  for(uint8_t i=u8_lFirst;i<u8_lLast;i++)
   {
-    str_lIsBalance="AUS";
-    str_lError="#00ff00 OK#";
-    if(lDataDisp->bmsIsBalancingActive[i]>0)str_lIsBalance="EIN";
-    if(lDataDisp->bmsErrors[i]>0)
+    if((lDirty->u8_bms[i]&(DIRTY_BMS_TOTALS|DIRTY_BMS_TEMPS|DIRTY_BMS_STATUS))==0)
     {
-      str_lError="#ff0000 ERR#";
-      bo_lBmsHasError=true;
+      u8_lObjCnt++;
+      continue;
     }
 
-    label = lv_obj_get_child(tabSerBmsOverview, u8_lObjCnt);
+    label = lv_obj_get_child(tab, u8_lObjCnt);
 
+    //Kopfzeile
+    char *p=txtBuf;
+    p=fmtStr(p, devType);
+    p=fmtUInt(p, u8_lObjCnt-1);
+  
+    //TODO Online/Offline-Flag nutzen (noch nicht in i2c drin auf Display-Seite)
     if((lDataDisp->bmsMaxCellVoltage[i] != UINT16_MAX) && (lDataDisp->bmsMaxCellVoltage[i] != 0))       //Gerät verfügbar
     {
       lv_label_set_recolor(label, true);
-      lv_label_set_text_fmt(label, "S%d\n\n%.1f\n%.1f\n%d\n%d\n\n%d\n\n%d\n\n%.1f\n%s\n%s", u8_lObjCnt-1,
-      lDataDisp->bmsTotalVoltage[i]/100.0, lDataDisp->bmsTotalCurrent[i]/100.0, lDataDisp->bmsChargePercentage[i], lDataDisp->bmsMaxCellVoltage[i],
-      lDataDisp->bmsMinCellVoltage[i], lDataDisp->bmsMaxCellDifferenceVoltage[i], lDataDisp->bmsTemperature[i][0]/100.0, str_lIsBalance.c_str(),
-      str_lError.c_str());
-    }
-    else                                                              //Gerät nicht verfügbar -> Spalte ausblenden
-    {
-      lv_label_set_text_fmt(label, "S%d", u8_lObjCnt-1);               //Kopfzeile setzen
+      p=fmtStr(p, "\n\n");
+      p=fmtFixed(p, lDataDisp->bmsTotalVoltage[i], 2, 1);
+      p=fmtStr(p, "\n");
+      p=fmtFixed(p, lDataDisp->bmsTotalCurrent[i], 2, 1);
+      p=fmtStr(p, "\n");
+      p=fmtUInt(p, lDataDisp->bmsChargePercentage[i]);
+      p=fmtStr(p, "\n");
+      p=fmtUInt(p, lDataDisp->bmsMaxCellVoltage[i]);
+      p=fmtStr(p, "\n\n");
+      p=fmtUInt(p, lDataDisp->bmsMinCellVoltage[i]);
+      p=fmtStr(p, "\n\n");
+      p=fmtUInt(p, lDataDisp->bmsMaxCellDifferenceVoltage[i]);
+      p=fmtStr(p, "\n\n");
+      p=fmtFixed(p, lDataDisp->bmsTemperature[i][0], 2, 1);
+      p=fmtStr(p, "\n");
+      p=fmtStr(p, (lDataDisp->bmsIsBalancingActive[i]>0) ? "EIN" : "AUS");
+      p=fmtStr(p, "\n");
+      p=fmtStr(p, (lDataDisp->bmsErrors[i]>0) ? "#ff0000 ERR#" : "#00ff00 OK#");
     }
+    //Gerät nicht verfügbar -> Spalte ausblenden, nur Kopfzeile
+
+    setLabelText(label, txtBuf);
 
     u8_lObjCnt++;
   }
+}
 
 
-  /****************************************
-   * Tab BT-BMS Overview
-   ****************************************/
-  u8_lObjCnt=1;
+//Bereich einer Zelle in Bildschirmkoordinaten
+static void cellArea(uint8_t u8_lBms, uint8_t u8_lCell, lv_area_t *area)
+{
+  lv_obj_get_coords(cellGrid, area);
+  area->x1 += zellColX(u8_lBms);
+  area->y1 += zellRowY(u8_lCell);
+  area->x2 = area->x1+COL_W-1;
+  area->y2 = area->y1+ROW_H-1;
+}
 
-  for(uint8_t i=0;i<5;i++)
-  {
-    str_lIsBalance="AUS";
-    str_lError="#00ff00 OK#";
-    if(lDataDisp->bmsIsBalancingActive[i]>0)str_lIsBalance="EIN";
-    if(lDataDisp->bmsErrors[i]>0)
-    {
-      str_lError="#ff0000 ERR#";
-      bo_lBmsHasError=true;
-    }
 
-    label = lv_obj_get_child(tabBTBmsOverview, u8_lObjCnt);
-  
-    //TODO Online/Offline-Flag nutzen (noch nicht in i2c drin auf Display-Seite)
-    if((lDataDisp->bmsMaxCellVoltage[i] != UINT16_MAX) && (lDataDisp->bmsMaxCellVoltage[i] != 0))       //Gerät verfügbar
-    {
-      lv_label_set_recolor(label, true);
-      lv_label_set_text_fmt(label, "Bt%d\n\n%.1f\n%.1f\n%d\n%d\n\n%d\n\n%d\n\n%.1f\n%s\n%s", u8_lObjCnt-1,
-      lDataDisp->bmsTotalVoltage[i]/100.0, lDataDisp->bmsTotalCurrent[i]/100.0, lDataDisp->bmsChargePercentage[i], lDataDisp->bmsMaxCellVoltage[i],
-      lDataDisp->bmsMinCellVoltage[i], lDataDisp->bmsMaxCellDifferenceVoltage[i], lDataDisp->bmsTemperature[i][0]/100.0, str_lIsBalance.c_str(),
-      str_lError.c_str());
-    }
-    else                                                              //Gerät nicht verfügbar -> Spalte ausblenden
+//Zelltext setzen; nur bei einer Änderung wird die Zelle zum Neuzeichnen vorgemerkt
+static void setCellText(uint8_t u8_lBms, uint8_t u8_lCell, const char *text)
+{
+  char *cell = cellTxt[u8_lBms][u8_lCell];
+  if(strcmp(cell, text)==0) return;
+  strncpy(cell, text, sizeof(cellTxt[0][0])-1);
+  cell[sizeof(cellTxt[0][0])-1]=0;
+
+  lv_area_t area;
+  cellArea(u8_lBms, u8_lCell, &area);
+  lv_obj_invalidate_area(cellGrid, &area);
+}
+
+
+//Alle Zellen zeichnen, die im aktuell gezeichneten Ausschnitt liegen
+static void cellGridDraw(lv_event_t *e)
+{
+  lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+  lv_draw_label_dsc_t label_dsc;
+  lv_draw_label_dsc_init(&label_dsc);
+  lv_obj_init_draw_label_dsc(cellGrid, LV_PART_MAIN, &label_dsc);
+
+  for(uint8_t i=0;i<BMS_DEVICES_COUNT;i++)
+  {
+    for(uint8_t c=0;c<DISP_CELL_COUNT;c++)
     {
-      lv_label_set_text_fmt(label, "Bt%d", u8_lObjCnt-1);               //Kopfzeile setzen
+      if(cellTxt[i][c][0]==0) continue;
+      lv_area_t area;
+      cellArea(i, c, &area);
+      if(!_lv_area_is_on(&area, draw_ctx->clip_area)) continue;
+      lv_draw_label(draw_ctx, &label_dsc, &area, cellTxt[i][c], NULL);
     }
-
-    u8_lObjCnt++;
   }
+}
 
 
+static void renderTabZellSpg(struct dataDirty_s *lDirty)
+{
   /****************************************
    * Tab Zellspannungen Overview
    ****************************************/
-  u8_lObjCnt=1;
-  String DevType = "Bt";
-  uint8_t DevID = u8_lObjCnt-1;
-
-  for(uint8_t i=0;i<8;i++)
+  for(uint8_t i=0;i<BMS_DEVICES_COUNT;i++)
   {
-    if(i>4)                                                                       //Serial BMS werden mit "S" benannt und ab 0 gezählt
+    if((lDirty->u8_bms[i]&DIRTY_BMS_CELLS)==0) continue;
+
+    //Nur geänderte Zellen; ändert sich die Verfügbarkeit, die ganze Spalte
+    uint32_t u32_lCells = lDirty->u32_cells[i];
+    bool bo_lAvailable = (lDataDisp->bmsCellVoltage[i][0] != UINT16_MAX) && (lDataDisp->bmsCellVoltage[i][0] != 0);
+    if(bo_lAvailable!=bo_mCellColVisible[i])
     {
-      DevType = "S";
-      DevID = (u8_lObjCnt-1)-5;
+      u32_lCells=(1UL<<DISP_CELL_COUNT)-1;
+      bo_mCellColVisible[i]=bo_lAvailable;
     }
-    else
+
+    for(uint8_t c=0;c<DISP_CELL_COUNT;c++)
     {
-      DevID = (u8_lObjCnt-1);
+      if((u32_lCells&(1UL<<c))==0) continue;
+
+      if(bo_lAvailable) fmtUInt(txtBuf, lDataDisp->bmsCellVoltage[i][c]);
+      else txtBuf[0]=0;                                              //Gerät nicht verfügbar -> Spalte ausblenden, nur Kopfzeile
+      setCellText(i, c, txtBuf);
     }
+  }
+}
 
-    label = lv_obj_get_child(tabZellSpg, u8_lObjCnt);
 
-    if((lDataDisp->bmsCellVoltage[i][0] != UINT16_MAX) && (lDataDisp->bmsCellVoltage[i][0] != 0))       //Gerät verfügbar
-    {      
-      lv_label_set_text_fmt(label, "%s%d\n\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d\n%d", DevType.c_str(), DevID,
-      lDataDisp->bmsCellVoltage[i][0], lDataDisp->bmsCellVoltage[i][1], lDataDisp->bmsCellVoltage[i][2], lDataDisp->bmsCellVoltage[i][3],
-      lDataDisp->bmsCellVoltage[i][4], lDataDisp->bmsCellVoltage[i][5], lDataDisp->bmsCellVoltage[i][6], lDataDisp->bmsCellVoltage[i][7],
-      lDataDisp->bmsCellVoltage[i][8], lDataDisp->bmsCellVoltage[i][9], lDataDisp->bmsCellVoltage[i][10], lDataDisp->bmsCellVoltage[i][11],
-      lDataDisp->bmsCellVoltage[i][12], lDataDisp->bmsCellVoltage[i][13], lDataDisp->bmsCellVoltage[i][14], lDataDisp->bmsCellVoltage[i][15]);
-    }
-    else                                                                          //Gerät nicht verfügbar -> Spalte ausblenden
+void displayNewBscData()
+{
+  //Panel aus: Daten liegen lassen, nach dem Aufwachen wird der dann neueste Zyklus vollständig gezeichnet
+  if(bo_mSleeping) return;
+
+  //Nur zeichnen, wenn seit dem letzten Aufruf ein neuer vollständiger Zyklus veröffentlicht wurde
+  if(getPublishedGeneration()==u32_mDisplayedGen) return;
+
+  //Neuesten vollständigen Zyklus übernehmen; lDataDisp bleibt bis zum nächsten Aufruf konsistent
+  if(!acquireData()) return;
+  TRACE_BEGIN(TRACE_DISP_DATA);
+  lDataDisp=getData();
+
+  //Die Dirty-Maske beschreibt nur die Änderung zum direkt vorherigen Zyklus.
+  //Beim ersten Zyklus oder wenn Zyklen übersprungen wurden, alles neu zeichnen.
+  uint32_t u32_lGen = getDataGeneration();
+  struct dataDirty_s lDirty;
+  if(u32_mDisplayedGen==0 || u32_lGen!=u32_mDisplayedGen+1) memset(&lDirty, 0xFF, sizeof(struct dataDirty_s));
+  else memcpy(&lDirty, &lDataDisp->dirty, sizeof(struct dataDirty_s));
+
+  u32_mCyclesSkipped += u32_lGen-u32_mDisplayedGen-1;
+  u32_mDisplayedGen = u32_lGen;
+
+  //Änderungen bei allen Tabs vormerken, gezeichnet wird nur der sichtbare
+  for(uint8_t t=0;t<TAB_COUNT;t++)
+  {
+    for(uint8_t i=0;i<BMS_DEVICES_COUNT;i++)
     {
-      lv_label_set_text_fmt(label, "%s%d", DevType.c_str(), DevID);               //Kopfzeile setzen
+      tabDirty[t].u8_bms[i] |= lDirty.u8_bms[i];
+      tabDirty[t].u32_cells[i] |= lDirty.u32_cells[i];
     }
+    tabDirty[t].u8_global |= lDirty.u8_global;
+  }
 
-    u8_lObjCnt++;
+  //Displaytimeout
+  if(lDirty.u8_global&DIRTY_BSC_SETTINGS) u8_mPowersaveTime=lDataDisp->displayTimeout;
+
+  //Zyklus mit CRC-Fehlern oder Lücken: Änderungen bleiben vorgemerkt und werden mit dem nächsten
+  //sauberen Zyklus gezeichnet. Bei dauerhaft gestörtem Bus nach DISP_SUSPECT_MAX trotzdem zeichnen.
+  if(lDataDisp->dirty.bo_suspect && u8_mSuspectRun<DISP_SUSPECT_MAX)
+  {
+    u8_mSuspectRun++;
+    u32_mCyclesSuspect++;
+    TRACE_END(TRACE_DISP_DATA);
+    return;
   }
-  
+  u8_mSuspectRun=0;
+  u32_mCyclesDrawn++;
 
-  /****************************************
-   * Tab BT-BMS Overview
-   ****************************************/
-  /* TODO Integrieren mit spezial Display FW
-  //IP-Adress
-  label = lv_obj_get_child(tabInfo, 3);
-  lv_label_set_text_fmt(label, "%s",lDataDisp->bscIpAdr);
+  renderTab(lv_tabview_get_tab_act(tabview));
+  setDisplayedGeneration(u32_lGen);
+  bootPhase(BOOT_FIRST_DATA);
+  TRACE_END(TRACE_DISP_DATA);
+}
 
-  //WLAN-Mode
-  label = lv_obj_get_child(tabInfo, 4);
-  lv_label_set_text_fmt(label, "%s",lDataDisp->bscWlanMode);        
 
-  //Mainboard FW-Version
-  label = lv_obj_get_child(tabInfo, 5);
-  lv_label_set_text_fmt(label, "%s",lDataDisp->bscFwVersion);
-*/
-  //Displaytimeout
-  u8_mPowersaveTime=lDataDisp->displayTimeout;
-}
\ No newline at end of file
+static void renderTab(uint16_t u16_lTab)
+{
+  if(lDataDisp==NULL || u16_lTab>=TAB_COUNT) return;   //Noch keine Daten empfangen
+  if(!bo_mTabBuilt[u16_lTab]) return;                   //Wird beim Aufbau vollständig gezeichnet
+
+  struct dataDirty_s *lDirty = &tabDirty[u16_lTab];
+
+  switch(u16_lTab)
+  {
+    case TAB_HOME:
+      renderTabHome(lDirty);
+      break;
+    case TAB_SER_BMS:
+      renderTabBmsOverview(lDirty, tabSerBmsOverview, BT_DEVICES_COUNT, BMS_DEVICES_COUNT, "S");
+      break;
+    case TAB_BT_BMS:
+      renderTabBmsOverview(lDirty, tabBTBmsOverview, 0, BT_DEVICES_COUNT, "Bt");
+      break;
+    case TAB_ZELL_SPG:
+      renderTabZellSpg(lDirty);
+      break;
+    case TAB_INFO:
+      /* TODO Integrieren mit spezial Display FW
+      //IP-Adress
+      label = lv_obj_get_child(tabInfo, 3);
+      lv_label_set_text_fmt(label, "%s",lDataDisp->bscIpAdr);
+
+      //WLAN-Mode
+      label = lv_obj_get_child(tabInfo, 4);
+      lv_label_set_text_fmt(label, "%s",lDataDisp->bscWlanMode);        
+
+      //Mainboard FW-Version
+      label = lv_obj_get_child(tabInfo, 5);
+      lv_label_set_text_fmt(label, "%s",lDataDisp->bscFwVersion);
+      */
+      break;
+    default:
+      break;
+  }
+
+  memset(lDirty, 0, sizeof(struct dataDirty_s));
+}
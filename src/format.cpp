@@ -0,0 +1,86 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "format.h"
+
+
+static const uint32_t u32_mPow10[] = {1,10,100,1000,10000,100000};
+
+
+char *fmtStr(char *p, const char *str)
+{
+  while(*str) *p++=*str++;
+  *p='\0';
+  return p;
+}
+
+
+char *fmtUInt(char *p, uint32_t u32_lValue)
+{
+  char tmp[10];
+  uint8_t u8_lLen=0;
+
+  do
+  {
+    tmp[u8_lLen++]='0'+(u32_lValue%10);
+    u32_lValue/=10;
+  } while(u32_lValue>0);
+
+  while(u8_lLen>0) *p++=tmp[--u8_lLen];
+  *p='\0';
+  return p;
+}
+
+
+char *fmtInt(char *p, int32_t i32_lValue)
+{
+  if(i32_lValue<0)
+  {
+    *p++='-';
+    return fmtUInt(p, (uint32_t)(-(int64_t)i32_lValue));
+  }
+  return fmtUInt(p, (uint32_t)i32_lValue);
+}
+
+
+char *fmtFixed(char *p, int32_t i32_lValue, uint8_t u8_lInDecimals, uint8_t u8_lOutDecimals)
+{
+  uint32_t u32_lAbs;
+  bool bo_lNeg = (i32_lValue<0);
+
+  u32_lAbs = bo_lNeg ? (uint32_t)(-(int64_t)i32_lValue) : (uint32_t)i32_lValue;
+
+  //Auf die gewünschte Anzahl Nachkommastellen skalieren
+  if(u8_lOutDecimals>=u8_lInDecimals)
+  {
+    u32_lAbs *= u32_mPow10[u8_lOutDecimals-u8_lInDecimals];
+  }
+  else
+  {
+    uint32_t u32_lDiv = u32_mPow10[u8_lInDecimals-u8_lOutDecimals];
+    u32_lAbs = (u32_lAbs+u32_lDiv/2)/u32_lDiv;
+  }
+
+  uint32_t u32_lScale = u32_mPow10[u8_lOutDecimals];
+  uint32_t u32_lInt = u32_lAbs/u32_lScale;
+  uint32_t u32_lFrac = u32_lAbs%u32_lScale;
+
+  if(bo_lNeg && u32_lAbs>0) *p++='-';
+  p=fmtUInt(p, u32_lInt);
+
+  if(u8_lOutDecimals>0)
+  {
+    *p++='.';
+    for(uint8_t i=u8_lOutDecimals;i>0;i--)
+    {
+      p[i-1]='0'+(u32_lFrac%10);
+      u32_lFrac/=10;
+    }
+    p+=u8_lOutDecimals;
+    *p='\0';
+  }
+
+  return p;
+}
@@ -9,174 +9,737 @@
 #include "data.h"
 #include "display.h"
 #include "Wire.h"
+#include "trace.h"
+#include <atomic>
+#include <stddef.h>
 
 
 void onReceive(int len);
-void processRxData();
+void onRequest();
+void processRxData(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen);
 
 TwoWire I2C = TwoWire(0);
 
 static struct data_s *lData;
-uint8_t i2cRxBuf[128];
-uint8_t u8_mI2cRxBufLen;
-bool newDisplayData;
 
+/*
+ * Empfangsring (Single Producer/Single Consumer)
+ * onReceive() legt nur die Rohdaten in einen freien Slot, dekodiert wird
+ * im i2c-Task über i2cProcessRxFrames(). Head/Tail laufen frei über 0..255.
+ */
+struct i2cRxFrame_s
+{
+  uint32_t u32_rxMicros;              //Empfangszeitpunkt
+  uint8_t  u8_len;
+  uint8_t  u8_data[I2C_RX_FRAME_MAX];
+};
+
+//Head/Tail sind uint8 und laufen frei über; das geht nur mit einer Zweierpotenz <= 128
+static_assert((I2C_RX_RING_SIZE & (I2C_RX_RING_SIZE-1))==0 && I2C_RX_RING_SIZE<=128, "I2C_RX_RING_SIZE muss eine Zweierpotenz <= 128 sein");
+
+static struct i2cRxFrame_s i2cRxRing[I2C_RX_RING_SIZE];
+static std::atomic<uint8_t> u8_mRingHead(0);   //Nur onReceive()
+static std::atomic<uint8_t> u8_mRingTail(0);   //Nur i2cProcessRxFrames()
+
+static TaskHandle_t taskHandleI2c = NULL;
+static TaskHandle_t taskHandleNotify = NULL;
+static uint32_t u32_mRxFrames = 0;
+static uint32_t u32_mRingOverflow = 0;
+static uint32_t u32_mDropOversize = 0;    //onReceive(); Frame länger als ein Slot
+static uint32_t u32_mDropShort = 0;       //Ab hier processRxData(); kürzer als der Header
+static uint32_t u32_mDropUnknown = 0;     //Gruppe/ID nicht in rxFields
+static uint32_t u32_mDropBmsNr = 0;       //BMS-Nummer außerhalb
+static uint32_t u32_mDropPayload = 0;     //Nutzdaten kürzer als das Feld
+static uint8_t  u8_mRingHighWater = 0;
+static struct latHist_s rxWake;           //onReceive() bis der i2c-Task den Frame aufnimmt
+
+//Bytes/Transaktionen je Zyklus, getrennt nach Einzel- und Sammelframes
+struct i2cCycleStats_s
+{
+  uint32_t u32_cycles;
+  uint32_t u32_frames;
+  uint32_t u32_bytes;
+};
+static struct i2cCycleStats_s cycleLegacy;
+static struct i2cCycleStats_s cycleBatch;
+static uint16_t u16_mCycleFrames = 0;
+static uint16_t u16_mCycleBytes = 0;
+static bool bo_mCycleBatch = false;
+
+//Basis für Delta-Frames der Zellspannungen (Bit n = BMS n)
+static uint32_t u32_mCellBaseline = 0;                                   //Vollständiger Frame übernommen
+static uint32_t u32_mCellFullReq = (1UL<<(BMS_DEVICES_COUNT))-1;  //Vollständigen Frame anfordern
+static uint32_t u32_mCellDeltas = 0;
+static uint32_t u32_mCellDeltaMismatch = 0;
+
+//Gesicherte Frames (I2C_FRAME_SEQ_CRC)
+static uint32_t u32_mCrcErrors = 0;
+static uint32_t u32_mSeqGaps = 0;
+static uint32_t u32_mCyclesSuspect = 0;
+static uint8_t  u8_mSeqLast = 0;
+static bool bo_mSeqValid = false;
+static bool bo_mCycleSuspect = false;
+
+//Snapshot-Empfang (SNAPSHOT_DATA)
+static uint8_t  u8_mSnapBuf[I2C_SNAPSHOT_MAX];
+static uint16_t u16_mSnapLen = 0;         //Gesamtlänge laut Teil 0
+static uint16_t u16_mSnapPos = 0;         //Bisher empfangen
+static uint8_t  u8_mSnapNext = 0;         //Erwarteter Teil; 0 = kein Snapshot offen
+static uint8_t  u8_mSnapChunks = 0;       //Anzahl Teile laut Teil 0; alle weiteren Teile müssen sie bestätigen
+static uint32_t u32_mSnapshots = 0;
+static uint32_t u32_mSnapshotAborted = 0;
+static bool bo_mSnapshotWanted = true;    //Statusregister: Snapshot anfordern; nach dem Start immer
+
+
+//Muss aus dem Task aufgerufen werden, der danach i2cProcessRxFrames() ausführt
 void initI2C()
 {
-  newDisplayData=false;
-  lData=getData();
+  lData=getStagingData();
+  taskHandleI2c=xTaskGetCurrentTaskHandle();
 
   I2C.onReceive(onReceive);
-  //I2C.onRequest(onRequest);
+  I2C.onRequest(onRequest);
   Serial.println(I2C.begin((uint8_t)I2C_DEV_ADDR,32,33,1000000));
 }
 
 
-/*void onRequest()
+void i2cSetNotifyTask(TaskHandle_t task)
+{
+  taskHandleNotify=task;
+}
+
+
+void i2cRequestSnapshot()
 {
-  I2C.print(i++);
-  I2C.print(" Packets.");
-  Serial.println("onRequest");
-}*/
+  bo_mSnapshotWanted=true;
+}
 
 
-void IRAM_ATTR onReceive(int len)
+static inline uint16_t saturate16(uint32_t u32_lVal)
 {
-  u8_mI2cRxBufLen=0;
+  return (u32_lVal>0xFFFF) ? 0xFFFF : u32_lVal;
+}
+
+
+//Statusregister (Aufbau siehe defines.h): Fähigkeiten, Zustand und Fehlerzähler für den BSC
+void onRequest()
+{
+  uint8_t u8_lFill = (uint8_t)(u8_mRingHead.load(std::memory_order_relaxed)-u8_mRingTail.load(std::memory_order_relaxed));
+  uint8_t u8_lStatus = 0;
+  if(displayIsSleeping()) u8_lStatus|=I2C_STATUS_SLEEPING;
+  if(bo_mSnapshotWanted) u8_lStatus|=I2C_STATUS_SNAPSHOT;
+  if(u8_lFill>I2C_RX_RING_SIZE/2) u8_lStatus|=I2C_STATUS_BUSY;
+
+  uint32_t u32_lGen = getDisplayedGeneration();
+  uint16_t u16_lDropped = saturate16(u32_mDropOversize+u32_mDropShort+u32_mDropUnknown+u32_mDropBmsNr+u32_mDropPayload+u32_mCrcErrors);
+  uint16_t u16_lOverflow = saturate16(u32_mRingOverflow);
+
+  uint8_t u8_lReg[I2C_STATUS_LEN];
+  u8_lReg[0]=I2C_PROTO_ID;
+  u8_lReg[1]=I2C_PROTO_VERSION;
+  u8_lReg[2]=I2C_CAP_BATCH|I2C_CAP_CELL_DELTA|I2C_CAP_CRC|I2C_CAP_SNAPSHOT;
+  u8_lReg[3]=(uint8_t)u32_mCellFullReq;
+  u8_lReg[4]=u8_lStatus;
+  u8_lReg[5]=u32_lGen & 0xFF;
+  u8_lReg[6]=(u32_lGen>>8) & 0xFF;
+  u8_lReg[7]=(u32_lGen>>16) & 0xFF;
+  u8_lReg[8]=(u32_lGen>>24) & 0xFF;
+  u8_lReg[9]=u16_lDropped & 0xFF;
+  u8_lReg[10]=u16_lDropped>>8;
+  u8_lReg[11]=u16_lOverflow & 0xFF;
+  u8_lReg[12]=u16_lOverflow>>8;
+  I2C.write(u8_lReg, I2C_STATUS_LEN);
+}
+
+
+//Wire-Callback; läuft in arduino-esp32 2.x im Slave-Task des Wire-Treibers, nicht im Interrupt
+void onReceive(int len)
+{
+  TRACE_BEGIN(TRACE_I2C_RX);
+  uint8_t u8_lHead = u8_mRingHead.load(std::memory_order_relaxed);
+  uint8_t u8_lFill = (uint8_t)(u8_lHead - u8_mRingTail.load(std::memory_order_acquire));
+
+  if(u8_lFill>=I2C_RX_RING_SIZE)
+  {
+    //Ring voll; Frame verwerfen. Der Zyklus ist damit unvollständig
+    while(I2C.available()) I2C.read();
+    u32_mRingOverflow++;
+    bo_mSnapshotWanted=true;
+    TRACE_END(TRACE_I2C_RX);
+    return;
+  }
+
+  if(len>I2C_RX_FRAME_MAX)
+  {
+    //Kann kein gültiger Frame sein; nicht abgeschnitten dekodieren
+    while(I2C.available()) I2C.read();
+    u32_mDropOversize++;
+    TRACE_END(TRACE_I2C_RX);
+    return;
+  }
 
-  while(I2C.available()){
-    i2cRxBuf[u8_mI2cRxBufLen]=I2C.read();
-    u8_mI2cRxBufLen++;
+  struct i2cRxFrame_s *rxFrame = &i2cRxRing[u8_lHead & (I2C_RX_RING_SIZE-1)];
+  uint8_t u8_lLen=0;
+  while(I2C.available())
+  {
+    uint8_t u8_lByte=I2C.read();
+    if(u8_lLen<I2C_RX_FRAME_MAX) rxFrame->u8_data[u8_lLen++]=u8_lByte;
   }
+  rxFrame->u8_len=u8_lLen;
+  rxFrame->u32_rxMicros=micros();
+
+  u8_mRingHead.store(u8_lHead+1, std::memory_order_release);
+
+  u32_mRxFrames++;
+  if(u8_lFill+1>u8_mRingHighWater) u8_mRingHighWater=u8_lFill+1;
 
-  processRxData();
+  if(taskHandleI2c!=NULL) xTaskNotifyGive(taskHandleI2c);
+  TRACE_END(TRACE_I2C_RX);
 }
 
-void IRAM_ATTR processRxData()
+
+#ifdef I2C_CAPTURE
+/*
+ * Mitschnitt der empfangenen Frames über Serial (Format siehe i2c.h).
+ * Läuft im i2c-Task, damit onReceive() kurz bleibt.
+ */
+static void captureFrame(const struct i2cRxFrame_s *rxFrame)
+{
+  uint8_t u8_lHdr[I2C_CAPTURE_HDR_LEN];
+  u8_lHdr[0]=I2C_CAPTURE_SYNC0;
+  u8_lHdr[1]=I2C_CAPTURE_SYNC1;
+  u8_lHdr[2]=rxFrame->u32_rxMicros & 0xFF;
+  u8_lHdr[3]=(rxFrame->u32_rxMicros>>8) & 0xFF;
+  u8_lHdr[4]=(rxFrame->u32_rxMicros>>16) & 0xFF;
+  u8_lHdr[5]=(rxFrame->u32_rxMicros>>24) & 0xFF;
+  u8_lHdr[6]=rxFrame->u8_len;
+  Serial.write(u8_lHdr, I2C_CAPTURE_HDR_LEN);
+  Serial.write(rxFrame->u8_data, rxFrame->u8_len);
+}
+#endif
+
+
+//Alle bis jetzt empfangenen Frames aus dem Ring dekodieren
+void i2cProcessRxFrames()
 {
-  if(u8_mI2cRxBufLen<4) return;
+  uint8_t u8_lTail = u8_mRingTail.load(std::memory_order_relaxed);
+  uint8_t u8_lHead = u8_mRingHead.load(std::memory_order_acquire);
+
+  while(u8_lTail!=u8_lHead)
+  {
+    struct i2cRxFrame_s *rxFrame = &i2cRxRing[u8_lTail & (I2C_RX_RING_SIZE-1)];
+    #ifdef I2C_CAPTURE
+    captureFrame(rxFrame);
+    #endif
+    latHistAdd(&rxWake, micros()-rxFrame->u32_rxMicros);
+    TRACE_BEGIN(TRACE_I2C_DECODE);
+    processRxData(rxFrame->u8_data, rxFrame->u8_len);
+    TRACE_END(TRACE_I2C_DECODE);
+
+    u8_lTail++;
+    u8_mRingTail.store(u8_lTail, std::memory_order_release);
+  }
+}
+
+
+void getI2cStats(struct i2cStats_s *stats)
+{
+  stats->u32_rxFrames=u32_mRxFrames;
+  stats->u32_ringOverflow=u32_mRingOverflow;
+  stats->u8_ringHighWater=u8_mRingHighWater;
+  stats->rxWake=rxWake;
+  stats->u32_stackFree=(taskHandleI2c!=NULL) ? uxTaskGetStackHighWaterMark(taskHandleI2c) : 0;
+  stats->u32_dropOversize=u32_mDropOversize;
+  stats->u32_dropShort=u32_mDropShort;
+  stats->u32_dropUnknown=u32_mDropUnknown;
+  stats->u32_dropBmsNr=u32_mDropBmsNr;
+  stats->u32_dropPayload=u32_mDropPayload;
+  stats->u32_cyclesLegacy=cycleLegacy.u32_cycles;
+  stats->u32_framesLegacy=cycleLegacy.u32_frames;
+  stats->u32_bytesLegacy=cycleLegacy.u32_bytes;
+  stats->u32_cyclesBatch=cycleBatch.u32_cycles;
+  stats->u32_framesBatch=cycleBatch.u32_frames;
+  stats->u32_bytesBatch=cycleBatch.u32_bytes;
+  stats->u32_cellDeltas=u32_mCellDeltas;
+  stats->u32_cellDeltaMismatch=u32_mCellDeltaMismatch;
+  stats->u32_crcErrors=u32_mCrcErrors;
+  stats->u32_seqGaps=u32_mSeqGaps;
+  stats->u32_cyclesSuspect=u32_mCyclesSuspect;
+  stats->u32_snapshots=u32_mSnapshots;
+  stats->u32_snapshotAborted=u32_mSnapshotAborted;
+}
+
 
-  uint8_t u8_lData0 = i2cRxBuf[0];
-  uint8_t u8_lData1 = i2cRxBuf[1];
-  uint8_t u8_lBmsNr=0;
+/*
+ * Beschreibung aller Felder, Index [Gruppe][ID] (siehe defines.h).
+ * u16_offset: Ziel in data_s; u8_len: Anzahl Bytes; u8_stride: Abstand je BMS (0 = kein BMS-Feld).
+ * Neue Felder werden nur hier eingetragen, der Dekoder selbst bleibt unverändert.
+ */
+#define RX_FIELD_GROUPS          4
+#define RX_FIELD_IDS             16
+#define RX_FIELD_END_OF_CYCLE    0x01  //Nach dem Feld den Zyklus veröffentlichen
+#define RX_FIELD_CELLS           0x02  //Zellspannungen vollständig; je Zelle vergleichen, setzt die Delta-Basis
+#define RX_FIELD_CELL_DELTA      0x04  //Zellspannungen als Delta; u8_len ist nur die Mindestlänge
 
-  switch (u8_lData0)
+struct rxField_s
+{
+  uint16_t u16_offset;
+  uint8_t  u8_len;
+  uint8_t  u8_stride;
+  uint8_t  u8_dirtyFlag;
+  uint8_t  u8_flags;
+};
+
+#define RX_FIELD_SIZE(field)            sizeof(((struct data_s *)0)->field)
+#define RX_BMS(field, dirty)            {offsetof(struct data_s, field), RX_FIELD_SIZE(field[0]), RX_FIELD_SIZE(field[0]), dirty, 0}
+#define RX_GLOBAL(field, dirty, flags)  {offsetof(struct data_s, field), RX_FIELD_SIZE(field), 0, dirty, flags}
+#define RX_CELLS(len, flags)            {offsetof(struct data_s, bmsCellVoltage), len, RX_FIELD_SIZE(bmsCellVoltage[0]), DIRTY_BMS_CELLS, flags}
+#define RX_NONE                         {0, 0, 0, 0, 0}
+
+static constexpr struct rxField_s rxFields[RX_FIELD_GROUPS][RX_FIELD_IDS] =
+{
+  //0x00
+  {RX_NONE},
+
+  //BMS_DATA
+  {
+    RX_NONE,
+    RX_CELLS(RX_FIELD_SIZE(bmsCellVoltage[0]), RX_FIELD_CELLS),       //BMS_CELL_VOLTAGE
+    RX_BMS(bmsTotalVoltage, DIRTY_BMS_TOTALS),                        //BMS_TOTAL_VOLTAGE
+    RX_BMS(bmsMaxCellDifferenceVoltage, DIRTY_BMS_TOTALS),            //BMS_MAX_CELL_DIFFERENCE_VOLTAGE
+    RX_BMS(bmsAvgVoltage, DIRTY_BMS_TOTALS),                          //BMS_AVG_VOLTAGE
+    RX_BMS(bmsTotalCurrent, DIRTY_BMS_TOTALS),                        //BMS_TOTAL_CURRENT
+    RX_BMS(bmsMaxCellVoltage, DIRTY_BMS_TOTALS),                      //BMS_MAX_CELL_VOLTAGE
+    RX_BMS(bmsMinCellVoltage, DIRTY_BMS_TOTALS),                      //BMS_MIN_CELL_VOLTAGE
+    RX_BMS(bmsMaxVoltageCellNumber, DIRTY_BMS_TOTALS),                //BMS_MAX_VOLTAGE_CELL_NUMBER
+    RX_BMS(bmsMinVoltageCellNumber, DIRTY_BMS_TOTALS),                //BMS_MIN_VOLTAGE_CELL_NUMBER
+    RX_BMS(bmsIsBalancingActive, DIRTY_BMS_STATUS),                   //BMS_IS_BALANCING_ACTIVE
+    RX_BMS(bmsBalancingCurrent, DIRTY_BMS_STATUS),                    //BMS_BALANCING_CURRENT
+    RX_BMS(bmsTemperature, DIRTY_BMS_TEMPS),                          //BMS_TEMPERATURE
+    RX_BMS(bmsChargePercentage, DIRTY_BMS_TOTALS),                    //BMS_CHARGE_PERCENT
+    RX_BMS(bmsErrors, DIRTY_BMS_STATUS),                              //BMS_ERRORS
+    RX_CELLS(CELL_DELTA_HDR, RX_FIELD_CELL_DELTA),                    //BMS_CELL_VOLTAGE_DELTA
+  },
+
+  //INVERTER_DATA
+  {
+    RX_NONE,
+    RX_GLOBAL(inverterVoltage, DIRTY_INVERTER, 0),                    //INVERTER_VOLTAGE
+    RX_GLOBAL(inverterCurrent, DIRTY_INVERTER, 0),                    //INVERTER_CURRENT
+    RX_GLOBAL(inverterSoc, DIRTY_INVERTER, 0),                        //INVERTER_SOC
+    RX_GLOBAL(inverterChargeCurrent, DIRTY_INVERTER, 0),              //INVERTER_CHARGE_CURRENT
+    RX_GLOBAL(inverterDischargeCurrent, DIRTY_INVERTER, 0),           //INVERTER_DISCHARG_CURRENT
+  },
+
+  //BSC_DATA
   {
-    case BMS_DATA:
-      u8_lBmsNr=i2cRxBuf[2];
-      switch (u8_lData1)
-      {
-        case BMS_CELL_VOLTAGE:
-          memcpy(&lData->bmsCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 48);
-          break;
+    RX_NONE,
+    RX_GLOBAL(bscAlarms, DIRTY_BSC_ALARMS, 0),                        //BSC_ALARMS
+    RX_NONE,                                                          //BSC_IP_ADDR; TODO Integrieren mit spezial Display FW
+    RX_GLOBAL(bscRelais, DIRTY_BSC_RELAIS, 0),                        //BSC_RELAIS
+    RX_GLOBAL(displayTimeout, DIRTY_BSC_SETTINGS, RX_FIELD_END_OF_CYCLE), //BSC_DISPLAY_TIMEOUT
+  },
+};
+
+static_assert(BMS_CELL_VOLTAGE_DELTA<RX_FIELD_IDS, "rxFields: ID ausserhalb der Tabelle");
+static_assert(rxFields[BMS_DATA][BMS_ERRORS].u16_offset==offsetof(struct data_s, bmsErrors), "rxFields: BMS_DATA falsch einsortiert");
+static_assert(rxFields[INVERTER_DATA][INVERTER_DISCHARG_CURRENT].u16_offset==offsetof(struct data_s, inverterDischargeCurrent), "rxFields: INVERTER_DATA falsch einsortiert");
+static_assert(rxFields[BSC_DATA][BSC_DISPLAY_TIMEOUT].u16_offset==offsetof(struct data_s, displayTimeout), "rxFields: BSC_DATA falsch einsortiert");
+static_assert(rxFields[BMS_DATA][BMS_CELL_VOLTAGE].u8_len==48, "rxFields: Zellspannungen müssen 48 Byte sein");
+static_assert(BMS_DEVICES_COUNT<=8, "Anforderungsmaske für vollständige Zellframes ist ein Byte");
+
+
+//CRC-8, Polynom 0x07
+static const uint8_t u8_mCrc8Table[256] =
+{
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+  0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+  0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+  0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+  0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+  0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+  0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+  0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+  0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+  0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+  0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+  0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+  0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+  0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+  0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+  0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+
+
+uint8_t i2cCrc8(const uint8_t *data, uint8_t u8_lLen)
+{
+  uint8_t u8_lCrc=0;
+  for(uint8_t i=0;i<u8_lLen;i++) u8_lCrc=u8_mCrc8Table[u8_lCrc^data[i]];
+  return u8_lCrc;
+}
 
-        case BMS_TOTAL_VOLTAGE:
-          memcpy(&lData->bmsTotalVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
 
-        case BMS_MAX_CELL_DIFFERENCE_VOLTAGE:
-          memcpy(&lData->bmsMaxCellDifferenceVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
+//Gesicherten Frame prüfen; Lücken in der Nummerierung markieren nur den Zyklus, der Frame selbst ist gültig
+static bool checkFrame(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen)
+{
+  if(u8_lRxBufLen<RXBUFF_OFFSET+1)
+  {
+    u32_mDropShort++;
+    bo_mCycleSuspect=true;
+    return false;
+  }
 
-        case BMS_AVG_VOLTAGE:
-          memcpy(&lData->bmsAvgVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
+  if(i2cCrc8(i2cRxBuf, u8_lRxBufLen-1)!=i2cRxBuf[u8_lRxBufLen-1])
+  {
+    u32_mCrcErrors++;
+    bo_mCycleSuspect=true;
+    return false;
+  }
+
+  uint8_t u8_lSeq = i2cRxBuf[3]&I2C_FRAME_SEQ_MASK;
+  uint8_t u8_lExpected = (u8_mSeqLast+1)&I2C_FRAME_SEQ_MASK;
+  if(bo_mSeqValid && u8_lSeq!=u8_lExpected)
+  {
+    u32_mSeqGaps+=(uint8_t)(u8_lSeq-u8_lExpected)&I2C_FRAME_SEQ_MASK;
+    bo_mCycleSuspect=true;
+    bo_mSnapshotWanted=true;
+  }
+  u8_mSeqLast=u8_lSeq;
+  bo_mSeqValid=true;
+  return true;
+}
 
-        case BMS_TOTAL_CURRENT:
-          memcpy(&lData->bmsTotalCurrent[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
 
-        case BMS_MAX_CELL_VOLTAGE:
-          memcpy(&lData->bmsMaxCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
+//Fletcher-16 über die Zellspannungen als Little-Endian-Bytes
+uint16_t i2cCellChecksum(const uint16_t *cells)
+{
+  uint16_t u16_lSum1=0, u16_lSum2=0;
+  for(uint8_t c=0;c<BMS_CELLS_MAX;c++)
+  {
+    u16_lSum1=(u16_lSum1+(cells[c]&0xFF))%255;
+    u16_lSum2=(u16_lSum2+u16_lSum1)%255;
+    u16_lSum1=(u16_lSum1+(cells[c]>>8))%255;
+    u16_lSum2=(u16_lSum2+u16_lSum1)%255;
+  }
+  return (u16_lSum2<<8)|u16_lSum1;
+}
 
-        case BMS_MIN_CELL_VOLTAGE:
-          memcpy(&lData->bmsMinCellVoltage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
 
-        case BMS_MAX_VOLTAGE_CELL_NUMBER:
-          memcpy(&lData->bmsMaxVoltageCellNumber[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1);
-          break;
+//Vollständiger Zellframe: nur geänderte Zellen übernehmen und markieren; danach ist die Delta-Basis gültig
+static void applyCells(uint8_t u8_lBmsNr, const uint8_t *payload)
+{
+  uint16_t *cells = lData->bmsCellVoltage[u8_lBmsNr];
+  uint32_t u32_lChanged=0;
+  for(uint8_t c=0;c<BMS_CELLS_MAX;c++)
+  {
+    uint16_t u16_lVal;
+    memcpy(&u16_lVal, &payload[c*2], 2);
+    if(cells[c]==u16_lVal) continue;
+    cells[c]=u16_lVal;
+    u32_lChanged|=(1UL<<c);
+  }
 
-        case BMS_MIN_VOLTAGE_CELL_NUMBER:
-          memcpy(&lData->bmsMinVoltageCellNumber[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1);
-          break;
+  if(u32_lChanged)
+  {
+    lData->dirty.u32_cells[u8_lBmsNr]|=u32_lChanged;
+    lData->dirty.u8_bms[u8_lBmsNr]|=DIRTY_BMS_CELLS;
+  }
+  u32_mCellBaseline|=(1UL<<u8_lBmsNr);
+  u32_mCellFullReq&=~(1UL<<u8_lBmsNr);
+}
 
-        case BMS_IS_BALANCING_ACTIVE:
-          memcpy(&lData->bmsIsBalancingActive[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1);
-          break;
 
-        case BMS_BALANCING_CURRENT:
-          memcpy(&lData->bmsBalancingCurrent[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 2);
-          break;
+//Delta-Frame gegen die zuletzt übernommenen Zellspannungen anwenden (Format siehe defines.h)
+static void applyCellDelta(uint8_t u8_lBmsNr, const uint8_t *payload, uint8_t u8_lLen)
+{
+  uint32_t u32_lMask = payload[2] | ((uint32_t)payload[3]<<8) | ((uint32_t)payload[4]<<16);
+  if(u8_lLen<CELL_DELTA_HDR+__builtin_popcount(u32_lMask))
+  {
+    u32_mDropPayload++;
+    return;
+  }
 
-        case BMS_TEMPERATURE:
-          memcpy(&lData->bmsTemperature[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 6);
-          break;
+  uint16_t *cells = lData->bmsCellVoltage[u8_lBmsNr];
+  uint16_t u16_lCheck = payload[0] | (payload[1]<<8);
+  if((u32_mCellBaseline&(1UL<<u8_lBmsNr))==0 || i2cCellChecksum(cells)!=u16_lCheck)
+  {
+    //Basis passt nicht zum BSC; bis zum nächsten vollständigen Frame keine Deltas mehr
+    u32_mCellDeltaMismatch++;
+    u32_mCellBaseline&=~(1UL<<u8_lBmsNr);
+    u32_mCellFullReq|=(1UL<<u8_lBmsNr);
+    return;
+  }
 
-        case BMS_CHARGE_PERCENT:
-          memcpy(&lData->bmsChargePercentage[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 1);
-          break;
+  const int8_t *delta = (const int8_t *)&payload[CELL_DELTA_HDR];
+  uint32_t u32_lChanged=0;
+  for(uint8_t c=0;c<BMS_CELLS_MAX;c++)
+  {
+    if((u32_lMask&(1UL<<c))==0) continue;
+    if(*delta!=0)
+    {
+      cells[c]+=*delta;
+      u32_lChanged|=(1UL<<c);
+    }
+    delta++;
+  }
 
-        case BMS_ERRORS:
-          memcpy(&lData->bmsErrors[u8_lBmsNr], &i2cRxBuf[RXBUFF_OFFSET], 4);
-          break;
+  if(u32_lChanged)
+  {
+    lData->dirty.u32_cells[u8_lBmsNr]|=u32_lChanged;
+    lData->dirty.u8_bms[u8_lBmsNr]|=DIRTY_BMS_CELLS;
+  }
+  u32_mCellDeltas++;
+}
 
-        default:
-          break;
-      }
-      break;
 
-    case INVERTER_DATA:
-      switch (u8_lData1)
-        {
-          case INVERTER_VOLTAGE:
-            memcpy(&lData->inverterVoltage, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-          case INVERTER_CURRENT:
-            memcpy(&lData->inverterCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-          case INVERTER_SOC:
-            memcpy(&lData->inverterSoc, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-          case INVERTER_CHARGE_CURRENT:
-            memcpy(&lData->inverterChargeCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-          case INVERTER_DISCHARG_CURRENT:
-            memcpy(&lData->inverterDischargeCurrent, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-        }
-        break;
-
-    case BSC_DATA:
-      switch (u8_lData1)
-        {
-          case BSC_ALARMS:
-            memcpy(&lData->bscAlarms, &i2cRxBuf[RXBUFF_OFFSET], 2);
-            break;
-/*TODO Integrieren mit spezial Display FW
-          case BSC_IP_ADDR:
-            memcpy(&lData->bscIpAdr, &i2cRxBuf[RXBUFF_OFFSET], 16);
-            break;
- */           
-          case BSC_RELAIS:
-            memcpy(&lData->bscRelais, &i2cRxBuf[RXBUFF_OFFSET], 1);
-            break;
-
-          case BSC_DISPLAY_TIMEOUT:
-            memcpy(&lData->displayTimeout, &i2cRxBuf[RXBUFF_OFFSET], 1);
-            newDisplayData=true; //Immer das letzte empfangene Element meldet "newDisplayData"
-            break;
-        }
-        break;
-
-    default:
+//Wert nur übernehmen, wenn er sich geändert hat, und dann die Feldgruppe als geändert markieren
+static inline void updateField(void *dst, const uint8_t *src, uint8_t u8_lLen, uint8_t *u8_lDirty, uint8_t u8_lFlag)
+{
+  if(memcmp(dst, src, u8_lLen)==0) return;
+  memcpy(dst, src, u8_lLen);
+  *u8_lDirty |= u8_lFlag;
+}
+
+
+//Gruppe/ID, BMS-Nummer und Länge eines Feldes prüfen, ohne etwas zu übernehmen
+static bool fieldValid(uint8_t u8_lGroup, uint8_t u8_lId, uint8_t u8_lBmsNr, uint8_t u8_lLen)
+{
+  if(u8_lGroup>=RX_FIELD_GROUPS || u8_lId>=RX_FIELD_IDS) return false;
+  const struct rxField_s *field = &rxFields[u8_lGroup][u8_lId];
+  if(field->u8_len==0 || u8_lLen<field->u8_len) return false;
+  if(field->u8_stride>0 && u8_lBmsNr>=BMS_DEVICES_COUNT) return false;
+  return true;
+}
+
+
+/*
+ * Ein Feld prüfen und übernehmen, je Tabelleneintrag eine eigene Instanz: Offset, Länge, Stride und Flags
+ * sind Konstanten, memcmp/memcpy werden mit fester Länge inline erzeugt (so schnell wie der frühere switch).
+ * Leere Einträge zählen als unbekannt. Gibt die Flags des Feldes zurück (RX_FIELD_END_OF_CYCLE), 0 wenn verworfen.
+ */
+template<uint8_t GROUP, uint8_t ID>
+static uint8_t applyFieldEntry(uint8_t u8_lBmsNr, const uint8_t *payload, uint8_t u8_lLen)
+{
+  constexpr struct rxField_s field = rxFields[GROUP][ID];
+  if(field.u8_len==0)
+  {
+    u32_mDropUnknown++;
+    return 0;
+  }
+  if(u8_lLen<field.u8_len)
+  {
+    u32_mDropPayload++;
+    return 0;
+  }
+
+  uint8_t *dst = (uint8_t *)lData + field.u16_offset;
+  uint8_t *u8_lDirty = &lData->dirty.u8_global;
+
+  if(field.u8_stride>0)                                              //Feld je BMS
+  {
+    if(u8_lBmsNr>=BMS_DEVICES_COUNT)
+    {
+      u32_mDropBmsNr++;
+      return 0;
+    }
+    dst += u8_lBmsNr*field.u8_stride;
+    u8_lDirty = &lData->dirty.u8_bms[u8_lBmsNr];
+  }
+
+  if(field.u8_flags&RX_FIELD_CELLS) applyCells(u8_lBmsNr, payload);
+  else if(field.u8_flags&RX_FIELD_CELL_DELTA) applyCellDelta(u8_lBmsNr, payload, u8_lLen);
+  else updateField(dst, payload, field.u8_len, u8_lDirty, field.u8_dirtyFlag);
+  return field.u8_flags;
+}
+
+typedef uint8_t (*rxFieldApply_t)(uint8_t u8_lBmsNr, const uint8_t *payload, uint8_t u8_lLen);
+
+#define RX_APPLY_ROW(g) \
+  {applyFieldEntry<g,0>,  applyFieldEntry<g,1>,  applyFieldEntry<g,2>,  applyFieldEntry<g,3>,  \
+   applyFieldEntry<g,4>,  applyFieldEntry<g,5>,  applyFieldEntry<g,6>,  applyFieldEntry<g,7>,  \
+   applyFieldEntry<g,8>,  applyFieldEntry<g,9>,  applyFieldEntry<g,10>, applyFieldEntry<g,11>, \
+   applyFieldEntry<g,12>, applyFieldEntry<g,13>, applyFieldEntry<g,14>, applyFieldEntry<g,15>}
+
+static const rxFieldApply_t rxFieldApply[RX_FIELD_GROUPS][RX_FIELD_IDS] =
+  {RX_APPLY_ROW(0), RX_APPLY_ROW(1), RX_APPLY_ROW(2), RX_APPLY_ROW(3)};
+static_assert(RX_FIELD_GROUPS==4 && RX_FIELD_IDS==16, "rxFieldApply: RX_APPLY_ROW an die Tabellengröße anpassen");
+
+
+//Ein Feld über seinen Tabelleneintrag übernehmen; Gruppe/ID außerhalb der Tabelle werden verworfen
+static inline uint8_t applyField(uint8_t u8_lGroup, uint8_t u8_lId, uint8_t u8_lBmsNr, const uint8_t *payload, uint8_t u8_lLen)
+{
+  if(u8_lGroup>=RX_FIELD_GROUPS || u8_lId>=RX_FIELD_IDS)
+  {
+    u32_mDropUnknown++;
+    return 0;
+  }
+  return rxFieldApply[u8_lGroup][u8_lId](u8_lBmsNr, payload, u8_lLen);
+}
+
+
+//Sammelframe: alle Datensätze in einem Durchlauf übernehmen; unbekannte IDs werden über die Länge übersprungen
+static uint8_t applyBatch(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen)
+{
+  uint8_t u8_lGroup = i2cRxBuf[1];
+  uint8_t u8_lBmsNr = i2cRxBuf[2];
+  uint8_t u8_lFlags = 0;
+  uint8_t u8_lPos = RXBUFF_OFFSET;
+
+  while(u8_lPos<u8_lRxBufLen)
+  {
+    if(u8_lRxBufLen-u8_lPos<BATCH_RECORD_HDR)
+    {
+      u32_mDropShort++;
+      break;
+    }
+    uint8_t u8_lId = i2cRxBuf[u8_lPos];
+    uint8_t u8_lLen = i2cRxBuf[u8_lPos+1];
+    u8_lPos+=BATCH_RECORD_HDR;
+    if(u8_lLen>u8_lRxBufLen-u8_lPos)
+    {
+      u32_mDropPayload++;                                            //Datensatz über das Frameende hinaus
       break;
+    }
+    u8_lFlags |= applyField(u8_lGroup, u8_lId, u8_lBmsNr, &i2cRxBuf[u8_lPos], u8_lLen);
+    u8_lPos+=u8_lLen;
   }
+  return u8_lFlags;
+}
+
+
+//Unvollständigen Snapshot verwerfen und beim BSC einen neuen anfordern
+static void abortSnapshot()
+{
+  u32_mSnapshotAborted++;
+  u8_mSnapNext=0;
+  bo_mSnapshotWanted=true;
 }
 
-bool hasNewDisplayData()
+
+//Teil eines Snapshots sammeln; der letzte Teil übernimmt den ganzen Snapshot oder nichts
+static uint8_t applySnapshotChunk(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen)
 {
-  return newDisplayData;
+  uint8_t u8_lChunk = i2cRxBuf[1];
+  uint8_t u8_lChunkCnt = i2cRxBuf[2];
+  const uint8_t *data = &i2cRxBuf[RXBUFF_OFFSET];
+  uint16_t u16_lLen = u8_lRxBufLen-RXBUFF_OFFSET;
+
+  if(u8_lChunk==0)
+  {
+    if(u8_mSnapNext!=0) abortSnapshot();                             //Vorheriger Snapshot unvollständig
+    if(u16_lLen<2)
+    {
+      u32_mDropShort++;
+      return 0;
+    }
+    u16_mSnapLen=data[0] | (data[1]<<8);
+    u16_mSnapPos=0;
+    u8_mSnapChunks=u8_lChunkCnt;
+    data+=2;
+    u16_lLen-=2;
+  }
+  else if(u8_lChunk!=u8_mSnapNext)
+  {
+    if(u8_mSnapNext!=0) abortSnapshot();                             //Teil fehlt
+    return 0;
+  }
+
+  if(u16_mSnapLen>I2C_SNAPSHOT_MAX || u16_lLen>u16_mSnapLen-u16_mSnapPos || u8_lChunkCnt!=u8_mSnapChunks ||
+    u8_lChunk>=u8_lChunkCnt)
+  {
+    abortSnapshot();
+    return 0;
+  }
+  memcpy(&u8_mSnapBuf[u16_mSnapPos], data, u16_lLen);
+  u16_mSnapPos+=u16_lLen;
+  u8_mSnapNext=u8_lChunk+1;
+  if(u8_mSnapNext<u8_lChunkCnt) return 0;
+
+  //Letzter Teil
+  if(u16_mSnapPos!=u16_mSnapLen)
+  {
+    abortSnapshot();
+    return 0;
+  }
+  u8_mSnapNext=0;
+
+  //Erst Struktur und alle Felder prüfen, damit nie ein halber Snapshot übernommen wird
+  uint16_t u16_lPos=0;
+  while(u16_lPos<u16_mSnapLen)
+  {
+    const uint8_t *rec = &u8_mSnapBuf[u16_lPos];
+    if(u16_mSnapLen-u16_lPos<SNAPSHOT_RECORD_HDR || rec[3]>u16_mSnapLen-u16_lPos-SNAPSHOT_RECORD_HDR ||
+      !fieldValid(rec[0], rec[1], rec[2], rec[3]))
+    {
+      abortSnapshot();
+      return 0;
+    }
+    u16_lPos+=SNAPSHOT_RECORD_HDR+u8_mSnapBuf[u16_lPos+3];
+  }
+
+  for(u16_lPos=0;u16_lPos<u16_mSnapLen;u16_lPos+=SNAPSHOT_RECORD_HDR+u8_mSnapBuf[u16_lPos+3])
+  {
+    const uint8_t *rec = &u8_mSnapBuf[u16_lPos];
+    applyField(rec[0], rec[1], rec[2], &rec[SNAPSHOT_RECORD_HDR], rec[3]);
+  }
+  u32_mSnapshots++;
+  bo_mSnapshotWanted=false;
+
+  //Der Snapshot ist in sich vollständig; Lücken davor betreffen ihn nicht
+  bo_mCycleSuspect=false;
+  return RX_FIELD_END_OF_CYCLE;
 }
 
+
+void processRxData(const uint8_t *i2cRxBuf, uint8_t u8_lRxBufLen)
+{
+  if(u8_lRxBufLen<RXBUFF_OFFSET)
+  {
+    u32_mDropShort++;
+    return;
+  }
+
+  u16_mCycleFrames++;
+  u16_mCycleBytes+=u8_lRxBufLen;
+
+  if(i2cRxBuf[3]&I2C_FRAME_SEQ_CRC)
+  {
+    if(!checkFrame(i2cRxBuf, u8_lRxBufLen)) return;
+    u8_lRxBufLen--;                                                  //CRC gehört nicht zu den Nutzdaten
+  }
+
+  uint8_t u8_lFlags;
+  if(i2cRxBuf[0]==BATCH_DATA)
+  {
+    u8_lFlags=applyBatch(i2cRxBuf, u8_lRxBufLen);
+    bo_mCycleBatch=true;
+  }
+  else if(i2cRxBuf[0]==SNAPSHOT_DATA)
+  {
+    u8_lFlags=applySnapshotChunk(i2cRxBuf, u8_lRxBufLen);
+    bo_mCycleBatch=true;
+  }
+  else
+  {
+    u8_lFlags=applyField(i2cRxBuf[0], i2cRxBuf[1], i2cRxBuf[2], &i2cRxBuf[RXBUFF_OFFSET], u8_lRxBufLen-RXBUFF_OFFSET);
+  }
+
+  if(u8_lFlags&RX_FIELD_END_OF_CYCLE)
+  {
+    struct i2cCycleStats_s *cycle = bo_mCycleBatch ? &cycleBatch : &cycleLegacy;
+    cycle->u32_cycles++;
+    cycle->u32_frames+=u16_mCycleFrames;
+    cycle->u32_bytes+=u16_mCycleBytes;
+    u16_mCycleFrames=0;
+    u16_mCycleBytes=0;
+    bo_mCycleBatch=false;
+
+    lData->dirty.bo_suspect=bo_mCycleSuspect;
+    if(bo_mCycleSuspect) u32_mCyclesSuspect++;
+    bo_mCycleSuspect=false;
+
+    publishData(); //Immer das letzte empfangene Element schließt den Zyklus ab
+    TRACE_INSTANT(TRACE_I2C_PUBLISH);
+    if(taskHandleNotify!=NULL) xTaskNotifyGive(taskHandleNotify);
+  }
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "Arduino.h"
+#include "latency.h"
+
+
+static uint8_t latHistBucket(uint32_t u32_lUs)
+{
+  uint8_t u8_lBucket = (u32_lUs==0) ? 0 : 32-__builtin_clz(u32_lUs);
+  return (u8_lBucket<LAT_HIST_BUCKETS) ? u8_lBucket : LAT_HIST_BUCKETS-1;
+}
+
+
+void latHistAdd(struct latHist_s *hist, uint32_t u32_lUs)
+{
+  hist->u32_count[latHistBucket(u32_lUs)]++;
+  if(u32_lUs>hist->u32_maxUs) hist->u32_maxUs=u32_lUs;
+}
+
+
+uint32_t latHistPercentile(const struct latHist_s *hist, uint16_t u16_lPermille)
+{
+  uint32_t u32_lTotal=0;
+  for(uint8_t b=0;b<LAT_HIST_BUCKETS;b++) u32_lTotal+=hist->u32_count[b];
+  if(u32_lTotal==0) return 0;
+
+  uint64_t u64_lLimit=((uint64_t)u32_lTotal*u16_lPermille+999)/1000;
+  uint32_t u32_lSum=0;
+  for(uint8_t b=0;b<LAT_HIST_BUCKETS-1;b++)
+  {
+    u32_lSum+=hist->u32_count[b];
+    if(u32_lSum>=u64_lLimit) return 1UL<<b;
+  }
+  return hist->u32_maxUs;   //Letzter Bucket ist nach oben offen
+}
+
+
+//Format: name: n=<Anzahl> p50<X p99<Y max=Z us | <Bucket-Obergrenze:Anzahl ... >=Untergrenze:Anzahl
+void latHistPrint(const char *name, const struct latHist_s *hist)
+{
+  uint32_t u32_lTotal=0;
+  for(uint8_t b=0;b<LAT_HIST_BUCKETS;b++) u32_lTotal+=hist->u32_count[b];
+
+  Serial.printf("%s: n=%u p50<%u p99<%u max=%u us |", name, u32_lTotal, latHistPercentile(hist, 500),
+    latHistPercentile(hist, 990), hist->u32_maxUs);
+  for(uint8_t b=0;b<LAT_HIST_BUCKETS;b++)
+  {
+    if(hist->u32_count[b]==0) continue;
+    if(b==LAT_HIST_BUCKETS-1) Serial.printf(" >=%lu:%u", 1UL<<(b-1), hist->u32_count[b]);
+    else Serial.printf(" <%lu:%u", 1UL<<b, hist->u32_count[b]);
+  }
+  Serial.printf("\n");
+}
@@ -27,7 +27,10 @@
 #define LV_COLOR_DEPTH 16
 
 /*Swap the 2 bytes of RGB565 color. Useful if the display has an 8-bit interface (e.g. SPI)*/
-#define LV_COLOR_16_SWAP 0
+/*1: LVGL rendert direkt in der Bytereihenfolge des Panels, display_flush() kopiert dann ohne Tausch*/
+#ifndef LV_COLOR_16_SWAP
+#define LV_COLOR_16_SWAP 1
+#endif
 
 /*Enable more complex drawing routines to manage screens transparency.
  *Can be used if the UI is above another layer, e.g. an OSD menu or video player.
@@ -46,7 +49,13 @@
  *=========================*/
 
 /*1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()`*/
+/*Mit PSRAM eigener Allocator (lvmem.cpp): Objekte, Styles und Texte ins PSRAM, Render-Zwischenpuffer in den internen RAM.
+ *Die Zeichenpuffer legt display.cpp selbst im internen RAM an.*/
+#ifdef BOARD_HAS_PSRAM
+#define LV_MEM_CUSTOM 1
+#else
 #define LV_MEM_CUSTOM 0
+#endif
 #if LV_MEM_CUSTOM == 0
 /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
 #  define LV_MEM_SIZE (32U * 1024U)          /*[bytes]*/
@@ -60,10 +69,10 @@
 #endif
 
 #else       /*LV_MEM_CUSTOM*/
-#  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-#  define LV_MEM_CUSTOM_ALLOC   malloc
-#  define LV_MEM_CUSTOM_FREE    free
-#  define LV_MEM_CUSTOM_REALLOC realloc
+#  define LV_MEM_CUSTOM_INCLUDE "lvmem.h"   /*Header for the dynamic memory function*/
+#  define LV_MEM_CUSTOM_ALLOC   lvMemAlloc
+#  define LV_MEM_CUSTOM_FREE    lvMemFree
+#  define LV_MEM_CUSTOM_REALLOC lvMemRealloc
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Number of the intermediate memory buffer used during rendering and other internal processing mechanisms.
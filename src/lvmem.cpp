@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Tobias Himmler
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "Arduino.h"
+#include <lvgl.h>
+#include "lvmem.h"
+
+#if LV_MEM_CUSTOM
+#include <esp_heap_caps.h>
+
+#if LVGL_VERSION_MAJOR!=8 || LVGL_VERSION_MINOR<3
+#error "lvmem.cpp braucht lv_disp_t::rendering_in_progress (LVGL 8.3)"
+#endif
+
+//Objekte, Styles und Texte kommen ins PSRAM. Was LVGL während des Renderns anlegt (lv_mem_buf, Masken,
+//Layer), kommt in den internen RAM, damit die Zeichenroutinen nicht über den PSRAM-Cache laufen.
+//Puffer, die LVGL außerhalb des Renderns anlegt und später wiederverwendet, bleiben wo sie sind.
+//Alle Aufrufe kommen aus dem Display-Task, daher ohne Sperre.
+
+//Vor jedem Block, damit free/realloc die Belegung nachführen können; 8 Byte halten die Ausrichtung
+struct lvMemHdr_s
+{
+  uint32_t u32_size;
+  uint32_t u32_psram;
+};
+
+static uint32_t u32_mBytes[2];           //[0] intern, [1] PSRAM
+static uint32_t u32_mPeak = 0;
+static uint32_t u32_mBlocks = 0;
+static uint32_t u32_mFallbacks = 0;
+
+
+static bool lvRendering()
+{
+  lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+  return disp!=NULL && disp->rendering_in_progress;
+}
+
+
+void *lvMemRealloc(void *p, size_t size)
+{
+  if(size==0)
+  {
+    lvMemFree(p);
+    return NULL;
+  }
+
+  struct lvMemHdr_s *hdr = (p!=NULL) ? (struct lvMemHdr_s *)p-1 : NULL;
+  uint32_t u32_lOldSize = (hdr!=NULL) ? hdr->u32_size : 0;
+  uint32_t u32_lOldPsram = (hdr!=NULL) ? hdr->u32_psram : 0;
+  size_t lTotal = sizeof(struct lvMemHdr_s)+size;
+
+  //heap_caps_realloc() verschiebt den Block bei Bedarf in den passenden Speicher und lässt ihn bei Fehler unverändert
+  struct lvMemHdr_s *lNew = NULL;
+  uint32_t u32_lPsram = 0;
+  bool bo_lWantPsram = !lvRendering();
+  if(bo_lWantPsram)
+  {
+    lNew = (struct lvMemHdr_s *)heap_caps_realloc(hdr, lTotal, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    u32_lPsram = 1;
+  }
+  if(lNew==NULL)
+  {
+    lNew = (struct lvMemHdr_s *)heap_caps_realloc(hdr, lTotal, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    u32_lPsram = 0;
+    if(lNew!=NULL && bo_lWantPsram) u32_mFallbacks++;
+  }
+  if(lNew==NULL) return NULL;
+
+  if(hdr!=NULL) u32_mBytes[u32_lOldPsram]-=u32_lOldSize;
+  else u32_mBlocks++;
+  lNew->u32_size=size;
+  lNew->u32_psram=u32_lPsram;
+  u32_mBytes[u32_lPsram]+=size;
+  if(u32_mBytes[0]+u32_mBytes[1]>u32_mPeak) u32_mPeak=u32_mBytes[0]+u32_mBytes[1];
+
+  return lNew+1;
+}
+
+
+void *lvMemAlloc(size_t size)
+{
+  return lvMemRealloc(NULL, size);
+}
+
+
+void lvMemFree(void *p)
+{
+  if(p==NULL) return;
+  struct lvMemHdr_s *hdr = (struct lvMemHdr_s *)p-1;
+  u32_mBytes[hdr->u32_psram]-=hdr->u32_size;
+  u32_mBlocks--;
+  heap_caps_free(hdr);
+}
+
+
+void getLvMemStats(struct lvMemStats_s *stats)
+{
+  stats->u32_psramBytes=u32_mBytes[1];
+  stats->u32_internalBytes=u32_mBytes[0];
+  stats->u32_peakBytes=u32_mPeak;
+  stats->u32_blocks=u32_mBlocks;
+  stats->u32_fallbacks=u32_mFallbacks;
+}
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright (c) 2022 Tobias Himmler
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+//LVGL-Allocator für Boards mit PSRAM (LV_MEM_CUSTOM in lv_conf.h).
+//Liegt neben lv_conf.h, weil LVGL selbst diesen Header einbindet; deshalb auch aus C nutzbar.
+
+#ifndef LVMEM_H
+#define LVMEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct lvMemStats_s
+{
+  uint32_t u32_psramBytes;      //Belegt im PSRAM (Objekte, Styles, Texte)
+  uint32_t u32_internalBytes;   //Belegt im internen RAM (Renderpuffer, Ausweichblöcke)
+  uint32_t u32_peakBytes;       //Max. belegt gesamt seit dem Start
+  uint32_t u32_blocks;          //Belegte Blöcke gesamt
+  uint32_t u32_fallbacks;       //Blöcke, die mangels PSRAM im internen RAM gelandet sind
+};
+
+void *lvMemAlloc(size_t size);
+void lvMemFree(void *p);
+void *lvMemRealloc(void *p, size_t size);
+void getLvMemStats(struct lvMemStats_s *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
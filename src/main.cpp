@@ -6,6 +6,11 @@
 #include "Arduino.h"
 #include "i2c.h"
 #include "display.h"
+#include "defines.h"
+#include "trace.h"
+#ifdef TASK_MEASURE_LATENCY
+#include "latency.h"
+#endif
 
 bool firstRun=true;
 
@@ -15,27 +20,59 @@ TaskHandle_t task_handle_display = NULL;
 
 void task_i2c(void *param)
 {
-  // init i2c
+  // init i2c; der Wire-Slave-Interrupt wird auf diesem Kern (TASK_CORE_I2C) installiert,
+  // onReceive()/onRequest() laufen im Slave-Task des Wire-Treibers
   initI2C();
 
   for (;;)
   {
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    //Warten bis onReceive() neue Frames meldet, dann den Empfangsring abarbeiten
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    i2cProcessRxFrames();
   }
 }
 
 
+#ifdef TASK_MEASURE_LATENCY
+static void printLatency()
+{
+  struct i2cStats_s i2cStats;
+  struct displayStats_s dispStats;
+  getI2cStats(&i2cStats);
+  getDisplayStats(&dispStats);
+  latHistPrint("i2c callback->task", &i2cStats.rxWake);
+  latHistPrint("display late", &dispStats.loopLate);
+  latHistPrint("lv_timer_handler", &dispStats.lvglRun);
+}
+#endif
+
+
 void task_display(void *param)
 {
   // init Display
   displayInit();
+  i2cSetNotifyTask(xTaskGetCurrentTaskHandle());
 
   for (;;)
   {
-    vTaskDelay(pdMS_TO_TICKS(5));
     displayNewBscData();
+    uint32_t u32_lNextMs = displayRunCyclic();
 
-    displayRunCyclic();
+    //Schlafen bis der I2C-Task einen neuen Zyklus meldet oder LVGL wieder dran ist
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(u32_lNextMs));
+
+    #ifdef TRACE_ENABLE
+    if(Serial.available() && Serial.read()=='t') traceDump();
+    #endif
+
+    #ifdef TASK_MEASURE_LATENCY
+    static uint32_t u32_lLastPrintMs=0;
+    if(millis()-u32_lLastPrintMs>=TASK_LATENCY_PRINT_MS)
+    {
+      u32_lLastPrintMs=millis();
+      printLatency();
+    }
+    #endif
   }
 }
 
@@ -44,9 +81,15 @@ void setup(void)
 {
   Serial.begin(115200);
 
-  // init Tasks
-  xTaskCreate(task_display, "display", 30000, nullptr, 5, &task_handle_display);
-  xTaskCreate(task_i2c, "i2c", 3000, nullptr, 4, &task_handle_i2c);
+  #ifdef BOARD_HAS_PSRAM
+  //LVGL legt Objekte und Styles im PSRAM an (lvmem.cpp). Fehlt es, weicht jeder Block in den internen RAM aus;
+  //hier nur melden, bevor die Tasks laufen und die Meldung im übrigen Log untergeht.
+  if(!psramFound()) Serial.println("PSRAM not found, LVGL heap falls back to internal RAM");
+  #endif
+
+  // init Tasks; I2C und LVGL auf getrennten Kernen, damit lange lv_timer_handler()-Läufe den Empfang nicht aufhalten
+  xTaskCreatePinnedToCore(task_display, "display", 30000, nullptr, TASK_PRIO_DISPLAY, &task_handle_display, TASK_CORE_DISPLAY);
+  xTaskCreatePinnedToCore(task_i2c, "i2c", 3000, nullptr, TASK_PRIO_I2C, &task_handle_i2c, TASK_CORE_I2C);
 }
 
 
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 Tobias Himmler
+// 
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "Arduino.h"
+#include "trace.h"
+
+#ifdef TRACE_ENABLE
+#include <atomic>
+
+static_assert((TRACE_RING_SIZE&(TRACE_RING_SIZE-1))==0, "TRACE_RING_SIZE muss eine Zweierpotenz sein");
+
+struct traceEvent_s
+{
+  uint32_t u32_us;
+  uint8_t  u8_id;
+  uint8_t  u8_type;
+  uint8_t  u8_core;
+};
+
+static const char *const traceNames[TRACE_ID_COUNT] = {
+  "i2c_rx", "i2c_decode", "i2c_publish", "disp_data", "lvgl", "flush", "flush_wait"
+};
+
+static struct traceEvent_s traceRing[TRACE_RING_SIZE];
+static std::atomic<uint32_t> u32_mTraceHead(0);   //Anzahl geschriebener Ereignisse seit dem letzten Dump
+static std::atomic<bool> bo_mTraceStopped(false); //Während traceDump() nicht schreiben
+static std::atomic<uint8_t> u8_mTraceWriters(0);  //Laufende traceRecord()
+
+/*
+ * Erst als Schreiber anmelden, dann den Stopp prüfen; traceDump() setzt erst den Stopp und wartet dann,
+ * bis keine Schreiber mehr angemeldet sind. Beides seq_cst: entweder sieht der Schreiber den Stopp
+ * oder traceDump() sieht den Schreiber und wartet auf ihn.
+ */
+void traceRecord(uint8_t u8_lId, uint8_t u8_lType)
+{
+  u8_mTraceWriters.fetch_add(1);
+  if(bo_mTraceStopped.load())
+  {
+    u8_mTraceWriters.fetch_sub(1);
+    return;
+  }
+
+  uint32_t u32_lIdx = u32_mTraceHead.fetch_add(1, std::memory_order_relaxed);
+  struct traceEvent_s *event = &traceRing[u32_lIdx & (TRACE_RING_SIZE-1)];
+  event->u32_us=micros();
+  event->u8_id=u8_lId;
+  event->u8_type=u8_lType;
+  event->u8_core=xPortGetCoreID();
+  u8_mTraceWriters.fetch_sub(1, std::memory_order_release);
+}
+
+
+//Ring ausgeben und leeren; Ereignisse während der Ausgabe gehen verloren
+void traceDump()
+{
+  bo_mTraceStopped.store(true);
+  //Laufende traceRecord() abschließen lassen; ein unterbrochener Schreiber auf demselben Kern braucht die CPU
+  while(u8_mTraceWriters.load()!=0) vTaskDelay(1);
+
+  uint32_t u32_lHead = u32_mTraceHead.load();
+  uint32_t u32_lCnt = (u32_lHead>TRACE_RING_SIZE) ? TRACE_RING_SIZE : u32_lHead;
+
+  Serial.printf("#TRACE %u %u\n", u32_lCnt, u32_lHead-u32_lCnt);
+  for(uint32_t i=u32_lHead-u32_lCnt;i!=u32_lHead;i++)
+  {
+    const struct traceEvent_s *event = &traceRing[i & (TRACE_RING_SIZE-1)];
+    if(event->u8_id>=TRACE_ID_COUNT) continue;
+    Serial.printf("#T %u %u %c %s\n", event->u32_us, event->u8_core, event->u8_type, traceNames[event->u8_id]);
+  }
+  Serial.printf("#TRACE END\n");
+
+  u32_mTraceHead.store(0);
+  bo_mTraceStopped.store(false);
+}
+#endif